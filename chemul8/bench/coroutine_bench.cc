@@ -0,0 +1,102 @@
+/*
+ * coroutine_bench.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "chip8.h"
+#include "emulation.h"
+
+/*
+	Runs the same machines once through Chip8::run_frame() and once through emulate()
+	coroutines interleaved on one thread. The difference per frame is what a yield costs.
+*/
+
+static const std::vector<uint8_t> program = {
+	0xA3, 0x00,		// 0x200 LD I, 0x300
+	0x70, 0x01,		// 0x202 ADD V0, #1
+	0xF0, 0x55,		// 0x204 LD [I], V0
+	0xC1, 0x3F,		// 0x206 RND V1, #3F
+	0xF1, 0x29,		// 0x208 LD F, V1
+	0xD1, 0x15,		// 0x20A DRW V1, V1, 5
+	0x12, 0x02,		// 0x20C JP 0x202
+};
+
+using Clock = std::chrono::steady_clock;
+
+static std::vector<Chip8> make_machines( size_t count )
+{
+	std::vector<Chip8> machines( count );
+
+	for( Chip8& machine : machines ) {
+		machine.set_program( program.data(), program.size() );
+		machine.set_seed( 1 );
+		machine.set_quirk_type( Chip8::eQuirkType::XOCHIP );
+	}
+
+	return machines;
+}
+
+static double nanoseconds_per_frame( Clock::duration elapsed, uint64_t frames )
+{
+	return std::chrono::duration<double, std::nano>( elapsed ).count() / frames;
+}
+
+int main( int argc, char *argv[] )
+{
+	const size_t machine_count = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 256;
+	const uint32_t frames = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 600;
+	const unsigned cycles = argc > 3 ? std::strtoul( argv[3], nullptr, 10 ) : 10;
+
+	std::vector<Chip8> direct = make_machines( machine_count );
+
+	auto start = Clock::now();
+	for( uint32_t frame = 0; frame < frames; ++frame )
+		for( Chip8& machine : direct )
+			machine.run_frame( cycles );
+	const double direct_ns = nanoseconds_per_frame( Clock::now() - start, uint64_t( frames ) * machine_count );
+
+	std::vector<Chip8> stepped = make_machines( machine_count );
+	std::vector<Emulation> runs;
+	for( Chip8& machine : stepped )
+		runs.push_back( emulate( machine, cycles, frames ) );
+
+	start = Clock::now();
+	for( uint32_t frame = 0; frame < frames; ++frame )
+		for( Emulation& run : runs )
+			run.next();
+	const double coroutine_ns = nanoseconds_per_frame( Clock::now() - start, uint64_t( frames ) * machine_count );
+
+	for( size_t index = 0; index < machine_count; ++index )
+		if( direct[index].get_state_hash() != stepped[index].get_state_hash() ) {
+			std::cerr << "machine " << index << " diverged" << std::endl;
+			return 1;
+		}
+
+	std::cout << machine_count << " machines, " << frames << " frames of " << cycles << " instructions\n";
+	std::cout << "run_frame  : " << direct_ns << " ns per frame\n";
+	std::cout << "coroutine  : " << coroutine_ns << " ns per frame\n";
+	std::cout << "per yield  : " << coroutine_ns - direct_ns << " ns ("
+			  << 100.0 * ( coroutine_ns - direct_ns ) / direct_ns << "% of a frame)\n";
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * throughput_bench.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "chip8.h"
+
+/*
+	Emulator throughput over the bundled ROM corpus and a few synthetic kernels.
+	Every ROM under GAMES and SGAMES runs once per quirk profile; the ROM directory is
+	the one in the source tree unless CHEMUL8_ROMS points elsewhere. Pass
+	--benchmark_format=json (or --benchmark_out=file.json) for trend tracking.
+*/
+
+static constexpr unsigned cycles_per_frame = 1000;
+
+struct Profile {
+	const char * name;
+	Chip8::eQuirkType type;
+};
+
+static const Profile profiles[] = {
+	{ "CHIP8", Chip8::eQuirkType::CHIP8 },
+	{ "SCHIP", Chip8::eQuirkType::SCHIP },
+	{ "XOCHIP", Chip8::eQuirkType::XOCHIP },
+};
+
+// Sprite drawing on every other instruction, which is the worst case for DRW
+static const std::vector<uint8_t> drw_kernel = {
+	0xC0, 0x3F,		// 0x200 RND V0, #3F
+	0xF0, 0x29,		// 0x202 LD F, V0
+	0xD0, 0x05,		// 0x204 DRW V0, V0, 5
+	0xD0, 0x05,		// 0x206 DRW V0, V0, 5
+	0x12, 0x00,		// 0x208 JP 0x200
+};
+
+// Register arithmetic only, no memory or display traffic
+static const std::vector<uint8_t> alu_kernel = {
+	0x70, 0x01,		// 0x200 ADD V0, #1
+	0x81, 0x04,		// 0x202 ADD V1, V0
+	0x82, 0x13,		// 0x204 XOR V2, V1
+	0x83, 0x26,		// 0x206 SHR V3, V2
+	0x84, 0x35,		// 0x208 SUB V4, V3
+	0x85, 0x41,		// 0x20A OR V5, V4
+	0x12, 0x00,		// 0x20C JP 0x200
+};
+
+static std::vector<uint8_t> read_rom( const std::filesystem::path& path )
+{
+	std::ifstream is( path, std::ios::binary );
+
+	return std::vector<uint8_t>( std::istreambuf_iterator<char>( is ), std::istreambuf_iterator<char>() );
+}
+
+static void load( Chip8& machine, const std::vector<uint8_t>& program, Chip8::eQuirkType type )
+{
+	machine.set_program( program.data(), program.size() );
+	machine.set_quirk_type( type );
+	machine.set_seed( 1 );
+}
+
+static void set_counters( benchmark::State& state, const Chip8& machine, uint64_t instructions_before )
+{
+	state.counters["IPS"] = benchmark::Counter( double( machine.get_stats().instructions - instructions_before ),
+												benchmark::Counter::kIsRate );
+	state.counters["frames/s"] = benchmark::Counter( double( state.iterations() ), benchmark::Counter::kIsRate );
+}
+
+static void run_frames( benchmark::State& state, std::vector<uint8_t> program, Chip8::eQuirkType type )
+{
+	Chip8 machine;
+	load( machine, program, type );
+
+	for( auto _ : state )
+		machine.run_frame( cycles_per_frame );
+
+	set_counters( state, machine, 0 );
+}
+
+static void BM_Reset( benchmark::State& state, std::vector<uint8_t> program )
+{
+	Chip8 machine;
+
+	for( auto _ : state ) {
+		load( machine, program, Chip8::eQuirkType::CHIP8 );
+		benchmark::DoNotOptimize( machine.get_state_hash() );
+	}
+
+	state.SetBytesProcessed( int64_t( state.iterations() ) * program.size() );
+}
+
+static void BM_Snapshot( benchmark::State& state, std::vector<uint8_t> program )
+{
+	Chip8 machine;
+	Chip8::Snapshot snapshot;
+
+	load( machine, program, Chip8::eQuirkType::XOCHIP );
+	machine.run_frame( cycles_per_frame );
+
+	for( auto _ : state ) {
+		machine.save_state( snapshot );
+		machine.restore_state( snapshot );
+	}
+
+	benchmark::DoNotOptimize( machine.get_state_hash() );
+}
+
+static void register_corpus( const std::filesystem::path& root )
+{
+	for( const char * set : { "GAMES", "SGAMES" } ) {
+		std::vector<std::filesystem::path> roms;
+
+		for( const auto& entry : std::filesystem::directory_iterator( root / set ) )
+			if( entry.is_regular_file() && !entry.path().has_extension() )		// skips the .DOC files
+				roms.push_back( entry.path() );
+
+		std::sort( roms.begin(), roms.end() );
+
+		for( const std::filesystem::path& rom : roms ) {
+			const std::vector<uint8_t> program = read_rom( rom );
+
+			for( const Profile& profile : profiles )
+				benchmark::RegisterBenchmark( ( std::string( "rom/" ) + set + "/" + rom.filename().string() + "/" + profile.name ).c_str(),
+											  run_frames, program, profile.type );
+		}
+	}
+}
+
+int main( int argc, char *argv[] )
+{
+	benchmark::Initialize( &argc, argv );
+
+	if( benchmark::ReportUnrecognizedArguments( argc, argv ) )
+		return 1;
+
+	for( const Profile& profile : profiles ) {
+		benchmark::RegisterBenchmark( ( std::string( "kernel/drw/" ) + profile.name ).c_str(), run_frames, drw_kernel, profile.type );
+		benchmark::RegisterBenchmark( ( std::string( "kernel/alu/" ) + profile.name ).c_str(), run_frames, alu_kernel, profile.type );
+	}
+
+	benchmark::RegisterBenchmark( "reset/drw_kernel", BM_Reset, drw_kernel );
+	benchmark::RegisterBenchmark( "snapshot/drw_kernel", BM_Snapshot, drw_kernel );
+
+	const char * roms = std::getenv( "CHEMUL8_ROMS" );
+	const std::filesystem::path root = roms ? roms : CHEMUL8_ROM_DIR;
+
+	if( std::filesystem::is_directory( root / "GAMES" ) ) {
+		const std::vector<uint8_t> blinky = read_rom( root / "GAMES" / "BLINKY" );
+
+		benchmark::RegisterBenchmark( "reset/BLINKY", BM_Reset, blinky );
+		benchmark::RegisterBenchmark( "snapshot/BLINKY", BM_Snapshot, blinky );
+
+		register_corpus( root );
+	}
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
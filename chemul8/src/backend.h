@@ -0,0 +1,62 @@
+/*
+ * backend.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+class InputLatch;
+
+/*
+	What the emulator front end needs from a windowing toolkit: a place to present the
+	display, a beeper, the host keyboard and a nanosecond clock for input timestamps.
+	check_events() and draw_buffer() are only called from the thread that created the
+	backend; get_ticks() may be called from any thread.
+*/
+class Backend
+{
+public:
+	virtual ~Backend() = default;
+
+	virtual void make_sound() = 0;
+	virtual void draw_buffer( const uint8_t *buffer, uint16_t size ) = 0;
+	virtual void check_events( InputLatch &input ) = 0;
+	virtual uint64_t get_ticks() const = 0;
+
+	void set_overlay( std::vector<std::string> lines ) { overlay = std::move( lines ); }
+	uint64_t get_render_time() const { return render_time; }		// ns spent in the last draw_buffer before present
+
+	bool should_quit() const { return last_event == Events::QUIT_EVENT; }
+	bool should_restart() const { return last_event == Events::RESTART_EVENT; }
+	bool set_new_type() const { return last_event == Events::SET_NEW_TYPE_EVENT; }
+	bool toggle_overlay() const { return last_event == Events::TOGGLE_OVERLAY_EVENT; }
+
+	int get_new_type() const { return new_type; }
+
+protected:
+	enum class Events { NO_EVENT, QUIT_EVENT, RESTART_EVENT, SET_NEW_TYPE_EVENT, TOGGLE_OVERLAY_EVENT };
+
+	Events last_event = Events::RESTART_EVENT;
+	int new_type = 0;
+	std::vector<std::string> overlay;
+	uint64_t render_time = 0;
+};
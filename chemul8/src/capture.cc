@@ -0,0 +1,294 @@
+/*
+ * capture.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "capture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+Y4MEncoder::Y4MEncoder( const std::string& file_name, unsigned scale )
+	: expander( scale ), os( file_name, std::ios::binary )
+{
+	if( !os )
+		throw std::runtime_error( "Cannot create " + file_name );
+
+	luma.resize( expander.width() * expander.height() );
+	chroma.assign( luma.size() / 4, 128 );
+
+	os << "YUV4MPEG2 W" << expander.width() << " H" << expander.height() << " F60:1 Ip A1:1 C420jpeg\n";
+}
+
+void Y4MEncoder::write_frame( const uint8_t * display )
+{
+	expander.to_luma( display, luma.data() );
+
+	os << "FRAME\n";
+	os.write( reinterpret_cast<const char *>( luma.data() ), luma.size() );
+	os.write( reinterpret_cast<const char *>( chroma.data() ), chroma.size() );	// U
+	os.write( reinterpret_cast<const char *>( chroma.data() ), chroma.size() );	// V
+}
+
+PNGSequenceEncoder::PNGSequenceEncoder( std::string prefix, unsigned scale, uint32_t foreground, uint32_t background )
+	: expander( scale ), prefix( std::move( prefix ) ), foreground( foreground ), background( background )
+{
+	pixels.resize( expander.width() * expander.height() );
+}
+
+void PNGSequenceEncoder::write_frame( const uint8_t * display )
+{
+	char number[16];
+	std::snprintf( number, sizeof( number ), "_%06u.png", frame_no++ );
+
+	expander.to_luma( display, pixels.data(), 1, 0 );
+
+	const std::vector<uint8_t> png = encode( pixels.data(), expander.width(), expander.height(), foreground, background );
+
+	std::ofstream os( prefix + number, std::ios::binary );
+	if( !os )
+		throw std::runtime_error( "Cannot create " + prefix + number );
+
+	os.write( reinterpret_cast<const char *>( png.data() ), png.size() );
+}
+
+namespace {
+
+uint32_t crc32( const uint8_t * data, size_t size, uint32_t crc = 0 )
+{
+	static const std::array<uint32_t, 256> table = []() {
+		std::array<uint32_t, 256> entries {};
+		for( uint32_t n = 0; n < 256; ++n ) {
+			uint32_t c = n;
+			for( int k = 0; k < 8; ++k )
+				c = ( c & 1 ) ? 0xEDB88320 ^ ( c >> 1 ) : c >> 1;
+			entries[n] = c;
+		}
+		return entries;
+	}();
+
+	crc = ~crc;
+	for( size_t index = 0; index < size; ++index )
+		crc = table[( crc ^ data[index] ) & 0xFF] ^ ( crc >> 8 );
+
+	return ~crc;
+}
+
+void put_be32( std::vector<uint8_t>& out, uint32_t value )
+{
+	out.push_back( value >> 24 );
+	out.push_back( value >> 16 );
+	out.push_back( value >> 8 );
+	out.push_back( value );
+}
+
+void put_chunk( std::vector<uint8_t>& out, const char * type, const std::vector<uint8_t>& data )
+{
+	put_be32( out, data.size() );
+
+	const size_t type_at = out.size();
+	out.insert( out.end(), type, type + 4 );
+	out.insert( out.end(), data.begin(), data.end() );
+
+	put_be32( out, crc32( &out[type_at], out.size() - type_at ) );
+}
+
+// zlib stream made of stored deflate blocks; the images are tiny, compressing them is not worth the time
+std::vector<uint8_t> zlib_store( const std::vector<uint8_t>& raw )
+{
+	std::vector<uint8_t> out = { 0x78, 0x01 };
+	uint32_t a = 1;
+	uint32_t b = 0;
+
+	size_t offset = 0;
+	do {
+		const size_t length = std::min<size_t>( raw.size() - offset, 0xFFFF );
+		const bool last = ( offset + length == raw.size() );
+
+		out.push_back( last ? 1 : 0 );
+		out.push_back( length & 0xFF );
+		out.push_back( length >> 8 );
+		out.push_back( ~length & 0xFF );
+		out.push_back( ( ~length >> 8 ) & 0xFF );
+		out.insert( out.end(), raw.begin() + offset, raw.begin() + offset + length );
+
+		offset += length;
+	} while( offset < raw.size() );
+
+	for( uint8_t byte : raw ) {
+		a = ( a + byte ) % 65521;
+		b = ( b + a ) % 65521;
+	}
+	put_be32( out, ( b << 16 ) | a );
+
+	return out;
+}
+
+}
+
+std::vector<uint8_t> PNGSequenceEncoder::encode( const uint8_t * pixels, unsigned width, unsigned height,
+												 uint32_t foreground, uint32_t background )
+{
+	static constexpr uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	std::vector<uint8_t> png( std::begin( signature ), std::end( signature ) );
+
+	std::vector<uint8_t> header;
+	put_be32( header, width );
+	put_be32( header, height );
+	header.insert( header.end(), { 1, 3, 0, 0, 0 } );	// 1 bit depth, palette, deflate, no filter, no interlace
+	put_chunk( png, "IHDR", header );
+
+	const std::vector<uint8_t> palette = {
+		uint8_t( background >> 16 ), uint8_t( background >> 8 ), uint8_t( background ),
+		uint8_t( foreground >> 16 ), uint8_t( foreground >> 8 ), uint8_t( foreground ),
+	};
+	put_chunk( png, "PLTE", palette );
+
+	const size_t row_bytes = ( width + 7 ) / 8;
+	std::vector<uint8_t> raw( ( row_bytes + 1 ) * height, 0 );
+
+	for( unsigned y = 0; y < height; ++y ) {
+		uint8_t * row = &raw[y * ( row_bytes + 1 ) + 1];		// leading filter byte stays 0
+
+		for( unsigned x = 0; x < width; ++x )
+			if( pixels[size_t( y ) * width + x] )
+				row[x / 8] |= 0x80 >> ( x % 8 );
+	}
+
+	put_chunk( png, "IDAT", zlib_store( raw ) );
+	put_chunk( png, "IEND", {} );
+
+	return png;
+}
+
+std::unique_ptr<FrameEncoder> make_frame_encoder( const std::string& target, unsigned scale )
+{
+	auto ends_with = [&target]( const std::string& suffix ) {
+		return target.size() >= suffix.size() && target.compare( target.size() - suffix.size(), suffix.size(), suffix ) == 0;
+	};
+
+	if( ends_with( ".y4m" ) )
+		return std::make_unique<Y4MEncoder>( target, scale );
+
+	if( ends_with( ".png" ) )
+		return std::make_unique<PNGSequenceEncoder>( target.substr( 0, target.size() - 4 ), scale );
+
+	return std::make_unique<PNGSequenceEncoder>( target, scale );
+}
+
+CaptureSink::CaptureSink( std::unique_ptr<FrameEncoder> encoder, size_t queue_depth )
+	: encoder( std::move( encoder ) ), queue( std::max<size_t>( queue_depth, 1 ) )
+{
+	thread = std::thread( &CaptureSink::encode_loop, this );
+}
+
+CaptureSink::~CaptureSink()
+{
+	stop();
+}
+
+void CaptureSink::submit( const uint8_t * display )
+{
+	std::unique_lock<std::mutex> guard( lock );
+	not_full.wait( guard, [this]() { return count < queue.size() || closing; } );
+
+	report_error();
+
+	if( closing )
+		return;
+
+	std::copy_n( display, queue[0].size(), queue[( head + count ) % queue.size()].begin() );
+	++count;
+
+	guard.unlock();
+	not_empty.notify_one();
+}
+
+// Drains whatever is still queued, then stops the encoder thread
+void CaptureSink::close()
+{
+	stop();
+
+	std::lock_guard<std::mutex> guard( lock );
+	report_error();
+}
+
+void CaptureSink::stop()
+{
+	{
+		std::lock_guard<std::mutex> guard( lock );
+		closing = true;
+	}
+	not_empty.notify_one();
+	not_full.notify_all();
+
+	if( thread.joinable() )
+		thread.join();
+}
+
+// Called with the lock held
+void CaptureSink::report_error()
+{
+	if( error )
+		std::rethrow_exception( std::exchange( error, nullptr ) );
+}
+
+uint64_t CaptureSink::frames_written() const
+{
+	std::lock_guard<std::mutex> guard( lock );
+	return written;
+}
+
+void CaptureSink::encode_loop()
+{
+	Frame frame;
+
+	while( true ) {
+		{
+			std::unique_lock<std::mutex> guard( lock );
+			not_empty.wait( guard, [this]() { return count > 0 || closing; } );
+
+			if( count == 0 )
+				return;
+
+			frame = queue[head];
+			head = ( head + 1 ) % queue.size();
+			--count;
+		}
+		not_full.notify_one();
+
+		try {
+			encoder->write_frame( frame.data() );
+		}
+		catch( ... ) {
+			{
+				std::lock_guard<std::mutex> guard( lock );
+				error = std::current_exception();
+				closing = true;
+				count = 0;
+			}
+			not_full.notify_all();
+			return;
+		}
+
+		std::lock_guard<std::mutex> guard( lock );
+		++written;
+	}
+}
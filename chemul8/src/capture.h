@@ -0,0 +1,122 @@
+/*
+ * capture.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_expander.h"
+
+class FrameEncoder
+{
+public:
+	static constexpr size_t display_size = FrameExpander::display_width * FrameExpander::display_height / 8;
+
+	virtual ~FrameEncoder() = default;
+
+	virtual void write_frame( const uint8_t * display ) = 0;
+};
+
+// YUV4MPEG2 stream, 4:2:0 with neutral chroma, 60 frames per second
+class Y4MEncoder : public FrameEncoder
+{
+public:
+	Y4MEncoder( const std::string& file_name, unsigned scale );
+
+	void write_frame( const uint8_t * display ) override;
+
+private:
+	FrameExpander expander;
+	std::ofstream os;
+	std::vector<uint8_t> luma;
+	std::vector<uint8_t> chroma;
+};
+
+// prefix_000000.png, prefix_000001.png, ... as two colour palette images
+class PNGSequenceEncoder : public FrameEncoder
+{
+public:
+	PNGSequenceEncoder( std::string prefix, unsigned scale, uint32_t foreground = 0xFFFFFF, uint32_t background = 0x000000 );
+
+	void write_frame( const uint8_t * display ) override;
+
+	static std::vector<uint8_t> encode( const uint8_t * pixels, unsigned width, unsigned height,
+										uint32_t foreground, uint32_t background );
+
+private:
+	FrameExpander expander;
+	std::string prefix;
+	uint32_t foreground;
+	uint32_t background;
+	unsigned frame_no = 0;
+	std::vector<uint8_t> pixels;
+};
+
+// "name.y4m" selects the Y4M encoder, anything else is used as PNG file prefix
+std::unique_ptr<FrameEncoder> make_frame_encoder( const std::string& target, unsigned scale );
+
+/*
+	Hands frames to an encoder running on its own thread. submit() only copies the
+	256 byte display into a bounded queue and blocks when the encoder falls that far behind.
+	When the encoder throws, the thread stops encoding and the next submit() or close()
+	rethrows the exception to the caller; frames after that are dropped.
+*/
+class CaptureSink
+{
+public:
+	explicit CaptureSink( std::unique_ptr<FrameEncoder> encoder, size_t queue_depth = 64 );
+	~CaptureSink();
+
+	CaptureSink( const CaptureSink& ) = delete;
+	CaptureSink& operator=( const CaptureSink& ) = delete;
+
+	void submit( const uint8_t * display );
+	void close();
+
+	uint64_t frames_written() const;
+
+private:
+	using Frame = std::array<uint8_t, FrameEncoder::display_size>;
+
+	std::unique_ptr<FrameEncoder> encoder;
+	std::vector<Frame> queue;
+	size_t head = 0;
+	size_t count = 0;
+	uint64_t written = 0;
+	bool closing = false;
+	std::exception_ptr error;			// thrown by the encoder, not yet reported
+
+	mutable std::mutex lock;
+	std::condition_variable not_empty;
+	std::condition_variable not_full;
+	std::thread thread;
+
+	void encode_loop();
+	void stop();
+	void report_error();
+};
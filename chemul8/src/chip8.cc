@@ -18,21 +18,26 @@
  */
 
 #include "chip8.h"
+#include "debugger.h"
 
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <cstring>
 #include <random>
+#include <utility>
 
 /*
-	memory layout:
+	memory layout, the first 512 bytes are kept apart from the paged program memory:
 
 	0x000–0x01F   CPU state (registers, I, PC, SP, timers, keys, quirks)  [32 bytes]
 	0x020–0x06F   Font sprites (80 bytes)
-	0x070–0x09F   Spare / interpreter scratch (48 bytes)
+	0x070–0x073   Random generator state (4 bytes)
+	0x074         Fault code (1 byte)
+	0x075–0x09F   Spare / interpreter scratch (43 bytes)
 	0x0A0–0x0FF   Stack (96 bytes, grows downward)
 	0x100–0x1FF   Display buffer (256 bytes)
-	0x200–0xFFF   Program + data
+	0x200–0xFFFF  Program + data (4 KB pages, zeroed when first written)
 
 */
 constexpr uint8_t QUIRK_RESET 		= 1 << 0;
@@ -41,17 +46,29 @@ constexpr uint8_t QUIRK_DISP_WAIT	= 1 << 2;
 constexpr uint8_t QUIRK_CLIPPING	= 1 << 3;
 constexpr uint8_t QUIRK_SHIFTING	= 1 << 4;
 constexpr uint8_t QUIRK_JUMPING		= 1 << 5;
+constexpr uint8_t QUIRK_WIDE_ADDRESS	= 1 << 6;
+
+const Chip8::DispatcherMap Chip8::dispatchers = {
+	{ 0x00, &Chip8::SYS },	  { 0x01, &Chip8::JP },	 { 0x02, &Chip8::CALL }, { 0x03, &Chip8::SEI },
+	{ 0x04, &Chip8::SNI },	  { 0x05, &Chip8::SER }, { 0x06, &Chip8::LD },	 { 0x07, &Chip8::ADD },
+	{ 0x08, &Chip8::MathOp }, { 0x09, &Chip8::SNE }, { 0x0A, &Chip8::LDI },	 { 0x0B, &Chip8::JMP },
+	{ 0x0C, &Chip8::RND },	  { 0x0D, &Chip8::DRW }, { 0x0E, &Chip8::Key },	 { 0x0F, &Chip8::Misc },
+};
+
+Chip8::Chip8() : seed( std::random_device{}() )
+{
+}
 
 void Chip8::set_quirk_type( eQuirkType type )
 {
 	switch( type ) {
-	case eQuirkType::CHIP8: memory[Quirk_index] = QUIRK_RESET | QUIRK_MEMORY | QUIRK_DISP_WAIT| QUIRK_CLIPPING; break;
-	case eQuirkType::XOCHIP : memory[Quirk_index] = QUIRK_MEMORY; break;
-	case eQuirkType::SCHIP : memory[Quirk_index] = QUIRK_CLIPPING | QUIRK_SHIFTING | QUIRK_JUMPING; break;
+	case eQuirkType::CHIP8: put( Quirk_index, QUIRK_RESET | QUIRK_MEMORY | QUIRK_DISP_WAIT| QUIRK_CLIPPING ); break;
+	case eQuirkType::XOCHIP : put( Quirk_index, QUIRK_MEMORY | QUIRK_WIDE_ADDRESS ); break;
+	case eQuirkType::SCHIP : put( Quirk_index, QUIRK_CLIPPING | QUIRK_SHIFTING | QUIRK_JUMPING ); break;
 	}
 }
 
-void Chip8::set_program( uint8_t *mem, size_t size )
+void Chip8::set_program( const uint8_t *mem, size_t size )
 {
 	static uint8_t font[] = {
 		/* 0 */ 0xF0, 0x90, 0x90, 0x90, 0xF0,
@@ -72,24 +89,114 @@ void Chip8::set_program( uint8_t *mem, size_t size )
 		/* F */ 0xF0, 0x80, 0xF0, 0x80, 0x80,
 	};
 
-	memset( memory, 0, sizeof( memory ) );
+	memset( state, 0, sizeof( state ) );
+	memory.clear();
+
+	memory.write( program_start, mem, std::min<size_t>( size, 0x10000 - program_start ) );
+	std::copy_n( &font[0], sizeof( font ), &state[font_sprite_base] );
 
-	std::copy_n( mem, size, &memory[program_start] );
-	std::copy_n( &font[0], sizeof( font ), &memory[font_sprite_base] );
+	rehash();
 
 	set_word( PC_index, program_start );
 	set_word( SP_index, stack_start );
+	set_seed( seed );
+
+	stats = {};
+	code_map.reset();
+	stored.reset();
+	modified_code.reset();
+	dirty_code_pages = 0;
+}
+
+/*
+	The generator state lives in memory (rather than in a static engine) so every instance
+	draws its own sequence and a given seed always reproduces the same run.
+*/
+void Chip8::set_seed( uint32_t new_seed )
+{
+	seed = new_seed ? new_seed : 0x2545F491;	// xorshift must never be seeded with 0
+
+	set_word( rng_index, seed >> 16 );
+	set_word( rng_index + 2, seed & 0xFFFF );
+}
+
+/*
+	The state hash is the sum over all bytes of value * key[address] (mod 2^64), so a
+	write only has to add key[address] * (new - old) to keep it current. Pages that were
+	never written hold zeroes and add nothing.
+*/
+static constexpr uint64_t make_hash_key( uint32_t address )
+{
+	uint64_t mixed = 0x9E3779B97F4A7C15 * ( address + 2 );		// splitmix64
+
+	mixed = ( mixed ^ ( mixed >> 30 ) ) * 0xBF58476D1CE4E5B9;
+	mixed = ( mixed ^ ( mixed >> 27 ) ) * 0x94D049BB133111EB;
+
+	return mixed ^ ( mixed >> 31 );
+}
+
+static constexpr std::array<uint64_t, 4096> make_hash_keys()
+{
+	std::array<uint64_t, 4096> keys {};
+
+	for( uint32_t address = 0; address < keys.size(); ++address )
+		keys[address] = make_hash_key( address );
+
+	return keys;
+}
+
+static constexpr std::array<uint64_t, 4096> hash_keys = make_hash_keys();
+
+static uint64_t hash_key( uint16_t address )
+{
+	return ( address < hash_keys.size() ) ? hash_keys[address] : make_hash_key( address );
+}
+
+void Chip8::put( uint16_t address, uint8_t value )
+{
+	uint8_t& cell = ( address < state_size ) ? state[address] : memory.at( address );
+
+	state_hash += hash_key( address ) * ( uint64_t( value ) - cell );
+	cell = value;
+}
+
+void Chip8::rehash()
+{
+	state_hash = 0;
+
+	for( uint16_t address = 0; address < state_size; ++address )
+		state_hash += hash_keys[address] * state[address];
+
+	for( unsigned page = 0; page < PagedMemory::page_count; ++page ) {
+		if( !( memory.present_pages() & ( 1u << page ) ) )
+			continue;
+
+		const uint8_t * data = memory.page_data( page );
+		const uint16_t base = page << PagedMemory::page_shift;
+
+		for( uint16_t offset = ( page ? 0 : state_size ); offset < PagedMemory::page_size; ++offset )
+			state_hash += hash_key( base + offset ) * data[offset];
+	}
 }
 
 uint16_t Chip8::get_word( uint16_t base ) const
 {
-	return (memory[base] << 8 ) | memory[base + 1];
+	return ( read( base ) << 8 ) | read( base + 1 );
+}
+
+/*
+	I reaches the full 64 KB on XO-CHIP; everywhere else it wraps at 4 KB like the
+	original interpreters.
+*/
+uint16_t Chip8::address_mask() const
+{
+	return ( state[Quirk_index] & QUIRK_WIDE_ADDRESS ) ? 0xFFFF : 0x0FFF;
 }
 
 void Chip8::set_word( uint16_t base, uint16_t value )
 {
-	memory[base] = value >> 8;
-	memory[base + 1] = value & 0xFF;
+	put( base, value >> 8 );
+	put( base + 1, value & 0xFF );
 }
 
 uint16_t Chip8::get_PC() const
@@ -104,12 +211,12 @@ void Chip8::set_PC( uint16_t value )
 
 uint8_t Chip8::get_register( uint8_t index ) const
 {
-	return memory[V_index + index ];
+	return state[V_index + index ];
 }
 
 void Chip8::set_register( uint8_t index, uint8_t value )
 {
-	memory[V_index + index] = value;
+	put( V_index + index, value );
 }
 
 void Chip8::set_I( uint16_t value )
@@ -117,11 +224,46 @@ void Chip8::set_I( uint16_t value )
 	set_word( I_index, value );
 }
 
-uint16_t Chip8::get_I(  )
+uint16_t Chip8::get_I() const
 {
 	return get_word( I_index );
 }
 
+/*
+	Pages holding code that has been written to since the last call. Anything caching
+	decoded instructions must drop what it has for these pages.
+*/
+uint16_t Chip8::take_dirty_code_pages()
+{
+	return std::exchange( dirty_code_pages, 0 );
+}
+
+/*
+	Stores made on behalf of the program (Fx33, Fx55) come through here so an attached
+	debugger sees every write into addressable memory.
+*/
+void Chip8::store_byte( uint16_t address, uint8_t value )
+{
+	address &= address_mask();
+	put( address, value );
+
+	++stats.stores;
+
+	if( address < code_map.size() ) {
+		stored.set( address );
+
+		if( code_map.test( address ) ) {
+			++stats.code_writes;
+			modified_code.set( address );
+			dirty_code_pages |= 1 << ( address >> 8 );
+			stack_checks = true;		// the stack proof was made for the code as loaded
+		}
+	}
+
+	if( debugger )
+		debugger->on_write( *this, address );
+}
+
 void Chip8::stack_push( uint16_t value )
 {
 	uint16_t address = get_word( SP_index );
@@ -132,6 +274,16 @@ void Chip8::stack_push( uint16_t value )
 	set_word( SP_index, address );
 }
 
+/*
+	The faulting instruction is executed again on every following tick, so the
+	machine stays where it went wrong until the program is reloaded.
+*/
+void Chip8::raise_fault( eFault fault )
+{
+	put( fault_index, uint8_t( fault ) );
+	set_PC( get_PC() - 2 );
+}
+
 uint16_t Chip8::stack_pop()
 {
 	uint16_t address = get_word( SP_index );
@@ -146,7 +298,8 @@ uint16_t Chip8::stack_pop()
 
 void Chip8::clear_screen()
 {
-	std::memset(&memory[display_base], 0, display_size);
+	for( uint16_t offset = 0; offset < display_size; ++offset )
+		put( display_base + offset, 0 );
 }
 
 bool Chip8::toggle_a_pixel( uint8_t x, uint8_t y )
@@ -157,8 +310,8 @@ bool Chip8::toggle_a_pixel( uint8_t x, uint8_t y )
 	if( byte_index >= display_size )
 		return false;
 
-	bool turned_off = ( memory[display_base + byte_index] & ( 1 << bit_offset ) );
-	memory[display_base + byte_index] ^= ( 1 << bit_offset );
+	bool turned_off = ( state[display_base + byte_index] & ( 1 << bit_offset ) );
+	put( display_base + byte_index, state[display_base + byte_index] ^ ( 1 << bit_offset ) );
 
 	return turned_off;
 }
@@ -187,7 +340,7 @@ bool Chip8::key_captured( uint8_t &key_no )
 
 void Chip8::set_interrupt( bool on )
 {
-	memory[int_index] = on ? 1 : 0;
+	put( int_index, on ? 1 : 0 );
 }
 
 void Chip8::set_keys_state( uint16_t new_state )
@@ -197,40 +350,63 @@ void Chip8::set_keys_state( uint16_t new_state )
 
 void Chip8::set_delay_timer( uint8_t value )
 {
-	memory[DT_index] = value;
+	put( DT_index, value );
 }
 
 void Chip8::set_sound_timer( uint8_t value )
 {
-	memory[ST_index] = value;
+	put( ST_index, value );
 }
 
 uint8_t Chip8::get_delay_timer() const
 {
-	return memory[DT_index];
+	return state[DT_index];
 }
 
 void Chip8::decrease_timers()
 {
-	if( memory[DT_index] > 0 )
-		--memory[DT_index];
+	if( state[DT_index] > 0 )
+		put( DT_index, state[DT_index] - 1 );
 
-	if( memory[ST_index] > 0 )
-		--memory[ST_index];
+	if( state[ST_index] > 0 )
+		put( ST_index, state[ST_index] - 1 );
 }
 
 
 uint8_t Chip8::get_random_value()
 {
-	static std::mt19937 mt{ std::random_device{}() };
+	uint32_t state = ( get_word( rng_index ) << 16 ) | get_word( rng_index + 2 );
 
-	std::uniform_int_distribution<> dist( 1, 255 );
-	return dist( mt );
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+
+	set_word( rng_index, state >> 16 );
+	set_word( rng_index + 2, state & 0xFFFF );
+
+	return 1 + ( state >> 8 ) % 255;
+}
+
+bool Chip8::is_halted() const
+{
+	return debugger && debugger->is_halted();
 }
 
 void Chip8::clock_tick( )
 {
-	const uint16_t opcode = get_word( get_PC() );
+	if( debugger && debugger->hold( *this ) )
+		return;
+
+	const uint16_t pc = get_PC() & 0xFFF;
+	const uint16_t opcode = get_word( pc );
+
+	code_map.set( pc );
+	code_map.set( ( pc + 1 ) & 0xFFF );
+	++stats.instructions;
+
+	// running bytes the program stored itself leaves the stack proof behind as well
+	if( !stack_checks && ( stored.test( pc ) || stored.test( ( pc + 1 ) & 0xFFF ) ) )
+		stack_checks = true;
 
 	set_PC( get_PC() + 2 );
 
@@ -238,6 +414,36 @@ void Chip8::clock_tick( )
 	( this->*fp_dispatch )( opcode );
 }
 
+void Chip8::save_state( Snapshot& snapshot ) const
+{
+	std::memcpy( snapshot.state, state, sizeof( state ) );
+	snapshot.memory = memory;
+	snapshot.state_hash = state_hash;
+}
+
+void Chip8::restore_state( const Snapshot& snapshot )
+{
+	std::memcpy( state, snapshot.state, sizeof( state ) );
+	memory = snapshot.memory;
+	state_hash = snapshot.state_hash;
+}
+
+/*
+	One 60Hz frame: the timers tick and the interrupt flag is raised for the first
+	instruction only, which is what releases a DRW held back by the display wait quirk.
+*/
+void Chip8::run_frame( unsigned cycles )
+{
+	decrease_timers();
+
+	for( unsigned cycle = 0; cycle < cycles; ++cycle ) {
+		set_interrupt( cycle == 0 );
+		clock_tick();
+	}
+
+	set_interrupt( false );
+}
+
 void Chip8::SYS( uint16_t opcode ) // 0nnn - SYS addr : Jump to a machine code routine at nnn.
 {
 	const uint16_t address = opcode & 0xFFF;
@@ -248,6 +454,10 @@ void Chip8::SYS( uint16_t opcode ) // 0nnn - SYS addr : Jump to a machine code r
 		break;
 
 	case 0x0EE: // RET : return from subroutine
+		if( stack_checks && get_word( SP_index ) >= stack_start ) {
+			raise_fault( eFault::STACK_UNDERFLOW );
+			break;
+		}
 		set_PC( stack_pop() );
 		// set_PC( Stack[SP--] );
 		break;
@@ -269,6 +479,11 @@ void Chip8::CALL( uint16_t opcode ) // 2nnn - CALL addr : Call subroutine at nnn
 {
 	const uint16_t address = opcode & 0xFFF;
 
+	if( stack_checks && get_word( SP_index ) < stack_end + 2 ) {
+		raise_fault( eFault::STACK_OVERFLOW );
+		return;
+	}
+
 	stack_push( get_PC() );
 	// ++SP;
 	// Stack[SP] = get_PC();
@@ -338,19 +553,19 @@ void Chip8::MathOp( uint16_t opcode ) // 8xyn - Various mathematical and logical
 
 	case 0x1: // OR Vx, Vy : Set Vx = Vx OR Vy
 		set_register( reg_x, get_register(reg_x) | get_register(reg_y) );
-		if( memory[Quirk_index] & QUIRK_RESET )
+		if( state[Quirk_index] & QUIRK_RESET )
 			set_register( 0x0F, 0 );
 		break;
 
 	case 0x2: // AND Vx, Vy : Set Vx = Vx AND Vy
 		set_register( reg_x, get_register(reg_x) & get_register(reg_y) );
-		if( memory[Quirk_index] & QUIRK_RESET )
+		if( state[Quirk_index] & QUIRK_RESET )
 			set_register( 0x0F, 0 );
 		break;
 
 	case 0x3: // XOR Vx, Vy : Set Vx = Vx XOR Vy
 		set_register( reg_x, get_register(reg_x) ^ get_register(reg_y) );
-		if( memory[Quirk_index] & QUIRK_RESET )
+		if( state[Quirk_index] & QUIRK_RESET )
 			set_register( 0x0F, 0 );
 		break;
 
@@ -376,7 +591,7 @@ void Chip8::MathOp( uint16_t opcode ) // 8xyn - Various mathematical and logical
 		{
 			const uint16_t result = ( get_register(reg_x) & 0x01 );
 
-			if( memory[Quirk_index] & QUIRK_SHIFTING )
+			if( state[Quirk_index] & QUIRK_SHIFTING )
 				set_register( reg_x, get_register(reg_x) >> 1);
 			else
 				set_register( reg_x, get_register(reg_y) >> 1);
@@ -399,7 +614,7 @@ void Chip8::MathOp( uint16_t opcode ) // 8xyn - Various mathematical and logical
 		{
 			const uint16_t result = ( get_register(reg_x) & 0x80 ) ? 1 : 0;
 
-			if( memory[Quirk_index] & QUIRK_SHIFTING )
+			if( state[Quirk_index] & QUIRK_SHIFTING )
 				set_register( reg_x, get_register(reg_x) << 1 );
 			else
 				set_register( reg_x, get_register(reg_y) << 1 );
@@ -443,7 +658,7 @@ void Chip8::JMP( uint16_t opcode )	// Bnnn - JP V0, addr : Jump to location nnn
 {
 	const uint8_t reg_x = ( opcode >> 8 ) & 0xF;
 
-	if( memory[Quirk_index] & QUIRK_JUMPING )
+	if( state[Quirk_index] & QUIRK_JUMPING )
 		set_PC( ( opcode & 0xFF ) + get_register( reg_x ) );	// ???
 	else
 		set_PC( ( opcode & 0xFFF ) + get_register(0) );
@@ -466,16 +681,18 @@ void Chip8::DRW( uint16_t opcode ) // Dxyn - DRW Vx, Vy, nibble : Display n-byte
 	set_register( 0x0F, 0 );
 	uint8_t ypos = get_register( reg_y ) % 32;
 
-	if( (memory[Quirk_index] & QUIRK_DISP_WAIT ) && !memory[int_index] ) { // rate limit the DRW calls to 60fps
+	if( (state[Quirk_index] & QUIRK_DISP_WAIT ) && !state[int_index] ) { // rate limit the DRW calls to 60fps
 		set_PC( get_PC() - 2 );
 		return;
 	}
 
+	++stats.draws;
+
 	uint8_t collision = get_register( 0x0F );
 	const uint8_t end_row = opcode & 0xF;
 	for( uint8_t row = 0; row < end_row; ++row ) {
 
-		const uint8_t sprite_byte = memory[ get_I() + row ];
+		const uint8_t sprite_byte = read( ( get_I() + row ) & address_mask() );
 		uint8_t xpos = get_register(reg_x) % 64;
 
 		for( uint8_t bit_offset = 0; bit_offset < 8; ++bit_offset ) {
@@ -485,13 +702,13 @@ void Chip8::DRW( uint16_t opcode ) // Dxyn - DRW Vx, Vy, nibble : Display n-byte
 
 			++xpos;
 
-			if( (memory[Quirk_index] & QUIRK_CLIPPING ) && ( xpos == 64 ) )
+			if( (state[Quirk_index] & QUIRK_CLIPPING ) && ( xpos == 64 ) )
 				break;
 		}
 
 		++ypos;
 
-		if( (memory[Quirk_index] & QUIRK_CLIPPING ) && ( ypos == 32 ) )
+		if( (state[Quirk_index] & QUIRK_CLIPPING ) && ( ypos == 32 ) )
 			break;
 	}
 
@@ -576,9 +793,9 @@ void Chip8::Misc( uint16_t opcode ) // 0xFxkk
 	// opcodes 0x2A .. 0x32 not defined
 
 	case 0x33: // Fx33 - LD B, Vx : Store BCD representation of Vx in memory locations I, I+1, and I+2
-		memory[get_I()] = get_register(reg_x) / 100;
-		memory[get_I() + 1] = ( get_register(reg_x) / 10 ) % 10;
-		memory[get_I() + 2] = get_register(reg_x) % 10;
+		store_byte( get_I(), get_register(reg_x) / 100 );
+		store_byte( get_I() + 1, ( get_register(reg_x) / 10 ) % 10 );
+		store_byte( get_I() + 2, get_register(reg_x) % 10 );
 		break;
 
 	// opcodes 0x34 .. 0x54 not defined
@@ -589,9 +806,9 @@ void Chip8::Misc( uint16_t opcode ) // 0xFxkk
 			uint16_t I_base = get_I();
 
 			for( ; idx <= reg_x; ++idx )
-				memory[I_base + idx] = get_register(idx);
+				store_byte( I_base + idx, get_register(idx) );
 
-			if( memory[Quirk_index] & QUIRK_MEMORY )
+			if( state[Quirk_index] & QUIRK_MEMORY )
 				set_I( get_I() + idx );
 
 		}
@@ -605,9 +822,9 @@ void Chip8::Misc( uint16_t opcode ) // 0xFxkk
 			uint16_t I_base = get_I();
 
 			for( ; idx <= reg_x; ++idx )
-				set_register( idx,  memory[I_base + idx] );
+				set_register( idx,  read( ( I_base + idx ) & address_mask() ) );
 
-			if( memory[Quirk_index] & QUIRK_MEMORY )
+			if( state[Quirk_index] & QUIRK_MEMORY )
 				set_I( get_I() + idx );
 
 		}
@@ -22,40 +22,106 @@
 
 #pragma once
 
+#include <bitset>
+#include <cstddef>
 #include <cstdint>
 #include <map>
 
+#include "paged_memory.h"
+
+class Debugger;
 
 class Chip8
 {
 public:
 	enum class eQuirkType { CHIP8, XOCHIP, SCHIP };
+	enum class eFault : uint8_t { NONE, STACK_OVERFLOW, STACK_UNDERFLOW };
+
+	static constexpr unsigned stack_capacity = 47;		// return addresses that fit in 0x0A0 - 0x0FF
+
+	struct Stats {
+		uint64_t instructions = 0;
+		uint64_t stores = 0;
+		uint64_t code_writes = 0;		// stores into bytes previously fetched as instructions
+		uint64_t draws = 0;
+	};
+
+	using AddressMap = std::bitset<4096>;
 
-	Chip8() = default;
+	// Everything needed to resume execution; statistics and the code maps are not part of it
+	struct Snapshot {
+		uint8_t state[0x200];
+		PagedMemory memory;		// only the pages the program has touched
+		uint64_t state_hash;
+	};
+
+	Chip8();
 
 	void set_quirk_type( eQuirkType type );
-	void set_program( uint8_t * mem, size_t size );
+	void set_program( const uint8_t * mem, size_t size );
+	void set_seed( uint32_t new_seed );
 	void set_interrupt( bool on );
 	void set_keys_state( uint16_t new_state );
 	void decrease_timers();
 	void clock_tick();
+	void run_frame( unsigned cycles );
+	void attach_debugger( Debugger * new_debugger ) { debugger = new_debugger; }
+
+	// Only switch the checks off for a program whose call depth is proven to fit the stack;
+	// they come back on once the program stores into code or runs bytes it stored
+	void set_stack_checks( bool on ) { stack_checks = on; }
+
+	bool is_halted() const;
+	eFault get_fault() const { return eFault( state[fault_index] ); }
 
-	bool get_sound_active() { return memory[ST_index] != 0; }
-	uint8_t * get_display_buffer() { return &memory[display_base]; }
+	uint16_t get_PC() const;
+	uint8_t get_register( uint8_t index ) const;
+	uint16_t get_I() const;
+	uint8_t get_delay_timer() const;
+
+	bool get_sound_active() { return state[ST_index] != 0; }
+	uint8_t * get_display_buffer() { return &state[display_base]; }
+	const uint8_t * get_display_buffer() const { return &state[display_base]; }
 	uint16_t get_display_size() { return display_size; }
+	uint8_t get_byte( uint16_t address ) const { return read( address ); }
+
+	const Stats& get_stats() const { return stats; }
+	const AddressMap& get_code_map() const { return code_map; }
+	const AddressMap& get_modified_code() const { return modified_code; }
+	uint16_t take_dirty_code_pages();
+
+	// 64-bit digest of the complete machine state, kept current on every write
+	uint64_t get_state_hash() const { return state_hash; }
+
+	void save_state( Snapshot& snapshot ) const;
+	void restore_state( const Snapshot& snapshot );
 
 private:
-	uint8_t memory[4096];
+	uint8_t state[0x200];			// machine state, always present
+	PagedMemory memory;				// 0x200 and up
+	uint32_t seed;
+	Debugger * debugger = nullptr;
+	bool stack_checks = true;
+
+	uint64_t state_hash = 0;
+	Stats stats;
+	AddressMap code_map;			// bytes fetched as instructions
+	AddressMap stored;				// bytes the program stored into since it was loaded
+	AddressMap modified_code;		// code bytes overwritten afterwards
+	uint16_t dirty_code_pages = 0;	// one bit per 256 byte page, cleared by take_dirty_code_pages()
 
 /*
-	memory layout:
+	memory layout, the first 512 bytes are kept apart from the paged program memory:
 
 	0x000–0x01F   CPU state (registers, I, PC, SP, timers, keys, quirks)  [32 bytes]
 	0x020–0x06F   Font sprites (80 bytes)
-	0x070–0x09F   Spare / interpreter scratch (48 bytes)
+	0x070–0x073   Random generator state (4 bytes)
+	0x074         Fault code (1 byte)
+	0x075–0x09F   Spare / interpreter scratch (43 bytes)
 	0x0A0–0x0FF   Stack (96 bytes, grows downward)
 	0x100–0x1FF   Display buffer (256 bytes)
-	0x200–0xFFF   Program + data
+	0x200–0xFFFF  Program + data, in 4 KB pages. Code runs from the first 4 KB;
+	              with the XO-CHIP quirks I reaches the full 64 KB.
 
 	NOTE: CHIP-8 memory layout; SCHIP/XO-CHIP require a different display model
 */
@@ -70,10 +136,13 @@ private:
 	static constexpr uint16_t int_index        = 0x001C;	// 1 byte
 	static constexpr uint16_t Quirk_index      = 0x001D;	// 1 byte
 	static constexpr uint16_t font_sprite_base = 0x0020;	// 80 bytes
+	static constexpr uint16_t rng_index        = 0x0070;	// 4 bytes
+	static constexpr uint16_t fault_index      = 0x0074;	// 1 byte
 	static constexpr uint16_t stack_end        = 0x00A0;
 	static constexpr uint16_t stack_start      = 0x00FF;	// 96 bytes (growing downwards)
 	static constexpr uint16_t display_base     = 0x0100;	// 256 bytes
-	static constexpr uint16_t program_start    = 0x0200;	// 3584 bytes
+	static constexpr uint16_t state_size       = 0x0200;
+	static constexpr uint16_t program_start    = 0x0200;	// up to 65024 bytes
 
 	static constexpr uint16_t display_width = 64;
 	static constexpr uint16_t display_height = 32;
@@ -82,12 +151,7 @@ private:
 	using Dispatcher = void ( Chip8::* )( uint16_t );
 	using DispatcherMap = std::map<uint8_t, Dispatcher>;
 
-	DispatcherMap dispatchers = {
-		{ 0x00, &Chip8::SYS },	  { 0x01, &Chip8::JP },	 { 0x02, &Chip8::CALL }, { 0x03, &Chip8::SEI },
-		{ 0x04, &Chip8::SNI },	  { 0x05, &Chip8::SER }, { 0x06, &Chip8::LD },	 { 0x07, &Chip8::ADD },
-		{ 0x08, &Chip8::MathOp }, { 0x09, &Chip8::SNE }, { 0x0A, &Chip8::LDI },	 { 0x0B, &Chip8::JMP },
-		{ 0x0C, &Chip8::RND },	  { 0x0D, &Chip8::DRW }, { 0x0E, &Chip8::Key },	 { 0x0F, &Chip8::Misc },
-	};
+	static const DispatcherMap dispatchers;		// shared by every instance
 
 	void SYS( uint16_t opcode );	// 0x0nnn
 	void JP( uint16_t opcode );		// 0x1nnn
@@ -111,15 +175,18 @@ private:
 	void set_register( uint8_t index, uint8_t value );
 	void set_I( uint16_t value );
 	void stack_push( uint16_t value );
+	void raise_fault( eFault fault );
 	void set_delay_timer( uint8_t value );
 	void set_sound_timer( uint8_t value );
 
+	uint8_t read( uint16_t address ) const { return ( address < state_size ) ? state[address] : memory.get( address ); }
+	void put( uint16_t address, uint8_t value );
+	void rehash();
+	void store_byte( uint16_t address, uint8_t value );
+
 	uint16_t get_word( uint16_t base ) const;
-	uint16_t get_PC() const;
-	uint8_t get_register( uint8_t index ) const;
-	uint16_t get_I();
+	uint16_t address_mask() const;
 	uint16_t stack_pop();
-	uint8_t get_delay_timer() const;
 	bool is_key_pressed( uint8_t key_no );
 	bool key_captured( uint8_t &key_no );
 	uint8_t get_random_value();
@@ -50,6 +50,15 @@ bool CmdLineParser::parse_args( int argc, char ** argv )
         ("C,chip8", "Emulate original Chip8")
         ("X,xochip", "Emulate the XOChip8")
         ("S,schip", "Emulate the Super Chip8")
+        ("stats", "Print execution statistics on exit")
+        ("hash-log", "Write the machine state hash of every frame to a file", cxxopts::value<std::string>())
+        ("seed", "Seed of the random number generator; a hash logged run uses 1 unless given", cxxopts::value<uint32_t>())
+        ("cycles", "Instructions per frame of a hash logged or headless run", cxxopts::value<unsigned>()->default_value("10"))
+        ("record", "Record every frame to file.y4m or a numbered PNG sequence", cxxopts::value<std::string>())
+        ("scale", "Pixel scale of recorded frames", cxxopts::value<unsigned>()->default_value("1"))
+        ("backend", "Video and input backend: sdl, gtk or offscreen (unpaced)", cxxopts::value<std::string>()->default_value("sdl"))
+        ("headless", "Run without a window, frames back to back, until --frames; for --record and --hash-log")
+        ("frames", "Quit after this many frames, 0 runs until quit", cxxopts::value<uint64_t>()->default_value("0"))
         ("h,help", "Print usage")
         ("romfile", "CHIP-8 ROM file to load", cxxopts::value<std::string>());
 
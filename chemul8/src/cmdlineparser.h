@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 #include "../vendor/cxxopts/cxxopts.hpp"
@@ -36,6 +38,15 @@ public:
 
 	// Quirks::eChipType get_chip_type() { return chip_type; };
 	std::string get_program();
+	bool show_stats() { return result.count( "stats" ) != 0; }
+	std::string get_hash_log() { return result.count( "hash-log" ) ? result["hash-log"].as<std::string>() : std::string(); }
+	std::optional<uint32_t> get_seed() { return result.count( "seed" ) ? std::optional<uint32_t>( result["seed"].as<uint32_t>() ) : std::nullopt; }
+	unsigned get_cycles() { return result["cycles"].as<unsigned>(); }
+	std::string get_record() { return result.count( "record" ) ? result["record"].as<std::string>() : std::string(); }
+	unsigned get_scale() { return result["scale"].as<unsigned>(); }
+	std::string get_backend() { return result["backend"].as<std::string>(); }
+	bool headless() { return result.count( "headless" ) != 0; }
+	uint64_t get_frames() { return result["frames"].as<uint64_t>(); }
 
 private:
     cxxopts::ParseResult result;
@@ -0,0 +1,334 @@
+/*
+ * debugger.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "debugger.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+/*
+	Recursive descent over the condition text, emitting code as it goes:
+
+		or      := and { "||" and }
+		and     := compare { "&&" compare }
+		compare := sum [ ( "==" | "!=" | "<" | "<=" | ">" | ">=" ) sum ]
+		sum     := unary { ( "+" | "-" | "&" ) unary }
+		unary   := "!" unary | primary
+		primary := number | Vx | I | PC | DT | "[" or "]" | "(" or ")"
+*/
+class ConditionCompiler
+{
+public:
+	explicit ConditionCompiler( const std::string& text ) : text( text ) {}
+
+	Condition compile()
+	{
+		parse_or();
+		skip_space();
+
+		if( pos != text.size() )
+			fail( "unexpected input" );
+
+		return result;
+	}
+
+private:
+	using Op = Condition::Op;
+
+	const std::string& text;
+	size_t pos = 0;
+	size_t depth = 0;
+	Condition result;
+
+	[[noreturn]] void fail( const std::string& what )
+	{
+		throw std::runtime_error( "Condition '" + text + "': " + what + " at column " + std::to_string( pos + 1 ) );
+	}
+
+	void emit( Op op, uint16_t arg, int stack_effect )
+	{
+		depth += stack_effect;
+		if( depth > Condition::max_depth )
+			fail( "expression too deep" );
+
+		result.code.push_back( { op, arg } );
+	}
+
+	void skip_space()
+	{
+		while( pos < text.size() && std::isspace( static_cast<unsigned char>( text[pos] ) ) )
+			++pos;
+	}
+
+	bool accept( const char * token )
+	{
+		skip_space();
+
+		const std::string_view wanted( token );
+		if( text.compare( pos, wanted.size(), wanted ) != 0 )
+			return false;
+
+		pos += wanted.size();
+		return true;
+	}
+
+	void parse_or()
+	{
+		parse_and();
+		while( accept( "||" ) ) {
+			parse_and();
+			emit( Op::OR, 0, -1 );
+		}
+	}
+
+	void parse_and()
+	{
+		parse_compare();
+		while( accept( "&&" ) ) {
+			parse_compare();
+			emit( Op::AND, 0, -1 );
+		}
+	}
+
+	void parse_compare()
+	{
+		static constexpr std::array<std::pair<const char *, Op>, 6> comparisons = { {
+			{ "==", Op::EQ }, { "!=", Op::NE }, { "<=", Op::LE }, { ">=", Op::GE }, { "<", Op::LT }, { ">", Op::GT },
+		} };
+
+		parse_sum();
+
+		for( const auto& [token, op] : comparisons )
+			if( accept( token ) ) {
+				parse_sum();
+				emit( op, 0, -1 );
+				return;
+			}
+	}
+
+	void parse_sum()
+	{
+		parse_unary();
+
+		while( true ) {
+			if( accept( "+" ) ) { parse_unary(); emit( Op::ADD, 0, -1 ); }
+			else if( accept( "-" ) ) { parse_unary(); emit( Op::SUB, 0, -1 ); }
+			else if( !at( "&&" ) && accept( "&" ) ) { parse_unary(); emit( Op::BIT_AND, 0, -1 ); }
+			else return;
+		}
+	}
+
+	bool at( const char * token )
+	{
+		skip_space();
+		return text.compare( pos, std::string_view( token ).size(), token ) == 0;
+	}
+
+	void parse_unary()
+	{
+		if( !at( "!=" ) && accept( "!" ) ) {
+			parse_unary();
+			emit( Op::NOT, 0, 0 );
+			return;
+		}
+
+		parse_primary();
+	}
+
+	void parse_primary()
+	{
+		skip_space();
+
+		if( pos >= text.size() )
+			fail( "operand expected" );
+
+		if( accept( "(" ) ) {
+			parse_or();
+			if( !accept( ")" ) )
+				fail( "')' expected" );
+			return;
+		}
+
+		if( accept( "[" ) ) {
+			parse_or();
+			if( !accept( "]" ) )
+				fail( "']' expected" );
+			emit( Op::LOAD, 0, 0 );
+			return;
+		}
+
+		if( std::isdigit( static_cast<unsigned char>( text[pos] ) ) ) {
+			// decimal, or hex after 0x; a leading 0 does not make a number octal
+			const bool hex = text.compare( pos, 2, "0x" ) == 0 || text.compare( pos, 2, "0X" ) == 0;
+			const char * first = text.data() + pos + ( hex ? 2 : 0 );
+			unsigned long value = 0;
+
+			const auto [last, error] = std::from_chars( first, text.data() + text.size(), value, hex ? 16 : 10 );
+			if( error == std::errc::invalid_argument )
+				fail( "digits expected" );
+			if( error == std::errc::result_out_of_range || value > 0xFFFF )
+				fail( "number out of range" );
+
+			pos = last - text.data();
+			emit( Op::PUSH, static_cast<uint16_t>( value ), 1 );
+			return;
+		}
+
+		std::string word;
+		while( pos < text.size() && std::isalnum( static_cast<unsigned char>( text[pos] ) ) )
+			word += std::toupper( static_cast<unsigned char>( text[pos++] ) );
+
+		if( word == "I" ) return emit( Op::PUSH_I, 0, 1 );
+		if( word == "PC" ) return emit( Op::PUSH_PC, 0, 1 );
+		if( word == "DT" ) return emit( Op::PUSH_DT, 0, 1 );
+
+		if( word.size() == 2 && word[0] == 'V' && std::isxdigit( static_cast<unsigned char>( word[1] ) ) )
+			return emit( Op::PUSH_V, std::stoi( word.substr( 1 ), nullptr, 16 ), 1 );
+
+		fail( "unknown operand '" + word + "'" );
+	}
+};
+
+Condition Condition::compile( const std::string& text )
+{
+	return ConditionCompiler( text ).compile();
+}
+
+bool Condition::evaluate( const Chip8& machine ) const
+{
+	std::array<int32_t, max_depth> stack;
+	size_t top = 0;
+
+	auto binary = [&]( auto operation ) {
+		--top;
+		stack[top - 1] = operation( stack[top - 1], stack[top] );
+	};
+
+	for( const Code& step : code ) {
+		switch( step.op ) {
+		case Op::PUSH:    stack[top++] = step.arg; break;
+		case Op::PUSH_V:  stack[top++] = machine.get_register( step.arg ); break;
+		case Op::PUSH_I:  stack[top++] = machine.get_I(); break;
+		case Op::PUSH_PC: stack[top++] = machine.get_PC(); break;
+		case Op::PUSH_DT: stack[top++] = machine.get_delay_timer(); break;
+		case Op::LOAD:    stack[top - 1] = machine.get_byte( stack[top - 1] ); break;
+		case Op::NOT:     stack[top - 1] = !stack[top - 1]; break;
+
+		case Op::ADD:     binary( []( int32_t a, int32_t b ) { return a + b; } ); break;
+		case Op::SUB:     binary( []( int32_t a, int32_t b ) { return a - b; } ); break;
+		case Op::BIT_AND: binary( []( int32_t a, int32_t b ) { return a & b; } ); break;
+		case Op::EQ:      binary( []( int32_t a, int32_t b ) { return a == b; } ); break;
+		case Op::NE:      binary( []( int32_t a, int32_t b ) { return a != b; } ); break;
+		case Op::LT:      binary( []( int32_t a, int32_t b ) { return a < b; } ); break;
+		case Op::LE:      binary( []( int32_t a, int32_t b ) { return a <= b; } ); break;
+		case Op::GT:      binary( []( int32_t a, int32_t b ) { return a > b; } ); break;
+		case Op::GE:      binary( []( int32_t a, int32_t b ) { return a >= b; } ); break;
+		case Op::AND:     binary( []( int32_t a, int32_t b ) { return a && b; } ); break;
+		case Op::OR:      binary( []( int32_t a, int32_t b ) { return a || b; } ); break;
+		}
+	}
+
+	return code.empty() || stack[0] != 0;
+}
+
+void Debugger::add_breakpoint( uint16_t address, Condition condition )
+{
+	address &= 0xFFF;
+
+	pc_bitmap.set( address );
+	breakpoints.push_back( { address, std::move( condition ) } );
+}
+
+void Debugger::remove_breakpoint( uint16_t address )
+{
+	address &= 0xFFF;
+
+	pc_bitmap.reset( address );
+	std::erase_if( breakpoints, [address]( const Breakpoint& breakpoint ) { return breakpoint.address == address; } );
+}
+
+void Debugger::add_watch( uint16_t address, uint16_t length, Condition condition )
+{
+	const uint16_t first = address;
+	const uint16_t last = std::min<uint32_t>( first + std::max<uint16_t>( length, 1 ) - 1, 0xFFFF );
+
+	for( unsigned page = first >> 8; page <= last >> 8u; ++page )
+		watched_pages.set( page );
+
+	watches.push_back( { first, last, std::move( condition ) } );
+}
+
+void Debugger::clear()
+{
+	pc_bitmap.reset();
+	watched_pages.reset();
+	breakpoints.clear();
+	watches.clear();
+}
+
+void Debugger::pause()
+{
+	halted = true;
+	event = Event { Event::eKind::PAUSE, 0, 0 };
+}
+
+/*
+	Continue execution. Only a breakpoint halts before its instruction, which then runs
+	without tripping the breakpoint again; after a watch or a pause PC has already moved
+	on and a breakpoint there must still fire.
+*/
+void Debugger::resume()
+{
+	if( !halted )
+		return;
+
+	halted = false;
+
+	if( event && event->kind == Event::eKind::BREAKPOINT )
+		step_over = event->pc;
+}
+
+bool Debugger::check_breakpoint( const Chip8& machine, uint16_t pc )
+{
+	for( const auto& breakpoint : breakpoints )
+		if( breakpoint.address == pc && breakpoint.condition.evaluate( machine ) ) {
+			halt( Event::eKind::BREAKPOINT, pc, pc );
+			return true;
+		}
+
+	return false;
+}
+
+void Debugger::check_watches( const Chip8& machine, uint16_t address )
+{
+	for( const auto& watch : watches )
+		if( address >= watch.first && address <= watch.last && watch.condition.evaluate( machine ) ) {
+			halt( Event::eKind::WATCH, machine.get_PC() - 2, address );	// PC already points past the store
+			return;
+		}
+}
+
+void Debugger::halt( Event::eKind kind, uint16_t pc, uint16_t address )
+{
+	halted = true;
+	event = Event { kind, pc, address };
+}
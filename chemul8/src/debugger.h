@@ -0,0 +1,140 @@
+/*
+ * debugger.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chip8.h"
+
+/*
+	A break condition compiled into a small stack based bytecode, e.g.
+
+		V3 == 0x10 && [I + 1] != 0
+
+	Operands are numbers (decimal, or hex after 0x), V0..VF, I, PC, DT and [expr] for a
+	memory byte.
+*/
+class Condition
+{
+public:
+	Condition() = default;
+
+	static Condition compile( const std::string& text );
+
+	bool empty() const { return code.empty(); }
+	bool evaluate( const Chip8& machine ) const;
+
+private:
+	enum class Op : uint8_t {
+		PUSH, PUSH_V, PUSH_I, PUSH_PC, PUSH_DT, LOAD,
+		ADD, SUB, BIT_AND, EQ, NE, LT, LE, GT, GE, AND, OR, NOT
+	};
+
+	struct Code {
+		Op op;
+		uint16_t arg;
+	};
+
+	static constexpr size_t max_depth = 16;
+
+	std::vector<Code> code;
+
+	friend class ConditionCompiler;
+};
+
+class Debugger
+{
+public:
+	struct Event {
+		enum class eKind { BREAKPOINT, WATCH, PAUSE };
+
+		eKind kind;
+		uint16_t pc;
+		uint16_t address;
+	};
+
+	Debugger() = default;
+
+	void add_breakpoint( uint16_t address, Condition condition = {} );
+	void remove_breakpoint( uint16_t address );
+	void add_watch( uint16_t address, uint16_t length = 1, Condition condition = {} );
+	void clear();
+
+	void pause();
+	void resume();
+
+	bool is_halted() const { return halted; }
+	const std::optional<Event>& last_event() const { return event; }
+
+	// Called by Chip8 before each instruction; true means the instruction must not run
+	bool hold( const Chip8& machine )
+	{
+		if( halted )
+			return true;
+
+		const uint16_t pc = machine.get_PC() & 0xFFF;
+
+		if( step_over ) {
+			const bool resumed_here = ( *step_over == pc );
+			step_over.reset();
+			if( resumed_here )
+				return false;
+		}
+
+		return pc_bitmap.test( pc ) && check_breakpoint( machine, pc );
+	}
+
+	// Called by Chip8 after a store into addressable memory
+	void on_write( const Chip8& machine, uint16_t address )
+	{
+		if( watched_pages.test( address >> 8 ) )
+			check_watches( machine, address );
+	}
+
+private:
+	struct Breakpoint {
+		uint16_t address;
+		Condition condition;
+	};
+
+	struct Watch {
+		uint16_t first;
+		uint16_t last;
+		Condition condition;
+	};
+
+	std::bitset<4096> pc_bitmap;
+	std::bitset<256> watched_pages;		// one bit per 256 byte page of the 64 KB address space
+
+	std::vector<Breakpoint> breakpoints;
+	std::vector<Watch> watches;
+
+	bool halted = false;
+	std::optional<uint16_t> step_over;		// breakpoint resumed from, passed once
+	std::optional<Event> event;
+
+	bool check_breakpoint( const Chip8& machine, uint16_t pc );
+	void check_watches( const Chip8& machine, uint16_t address );
+	void halt( Event::eKind kind, uint16_t pc, uint16_t address );
+};
@@ -0,0 +1,53 @@
+/*
+ * emulation.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "emulation.h"
+
+static bool waiting_for_key( const Chip8& machine )
+{
+	const uint16_t pc = machine.get_PC();
+
+	return ( machine.get_byte( pc ) & 0xF0 ) == 0xF0 && machine.get_byte( pc + 1 ) == 0x0A;
+}
+
+Emulation emulate( Chip8& machine, unsigned cycles_per_frame, uint32_t frame_limit )
+{
+	using eKind = StepEvent::eKind;
+
+	for( uint32_t frame = 0; frame < frame_limit; ++frame ) {
+		machine.decrease_timers();
+
+		for( unsigned cycle = 0; cycle < cycles_per_frame; ) {
+			const uint64_t executed = machine.get_stats().instructions;
+
+			machine.set_interrupt( cycle == 0 );
+			machine.clock_tick();
+
+			if( machine.is_halted() )
+				co_yield StepEvent { eKind::BREAKPOINT, frame, machine.get_PC() };
+
+			if( machine.get_stats().instructions != executed )		// a breakpoint holds the instruction back, retry it
+				++cycle;
+		}
+
+		machine.set_interrupt( false );
+
+		co_yield StepEvent { waiting_for_key( machine ) ? eKind::KEY_WAIT : eKind::FRAME, frame, machine.get_PC() };
+	}
+}
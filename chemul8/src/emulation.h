@@ -0,0 +1,103 @@
+/*
+ * emulation.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <utility>
+
+#include "chip8.h"
+
+struct StepEvent
+{
+	enum class eKind {
+		FRAME,			// a frame completed
+		KEY_WAIT,		// a frame completed with the machine blocked in Fx0A
+		BREAKPOINT,		// the attached debugger halted the machine
+	};
+
+	eKind kind;
+	uint32_t frame;
+	uint16_t pc;
+};
+
+/*
+	A machine running as a coroutine. Each next() runs it up to its next event and
+	returns; the host changes keys or inspects the machine in between. Many of these
+	can be interleaved on one thread, each one costs a coroutine frame and nothing else.
+
+		Emulation run = emulate( machine, 10 );
+		while( run.next() )
+			if( run.event().kind == StepEvent::eKind::FRAME )
+				present( machine.get_display_buffer() );
+*/
+class Emulation
+{
+public:
+	struct promise_type
+	{
+		StepEvent current {};
+
+		Emulation get_return_object() { return Emulation( Handle::from_promise( *this ) ); }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		std::suspend_always yield_value( StepEvent event ) noexcept { current = event; return {}; }
+		void return_void() noexcept {}
+		void unhandled_exception() { throw; }
+	};
+
+	using Handle = std::coroutine_handle<promise_type>;
+
+	Emulation( Emulation&& other ) noexcept : handle( std::exchange( other.handle, nullptr ) ) {}
+	Emulation& operator=( Emulation&& other ) noexcept
+	{
+		std::swap( handle, other.handle );
+		return *this;
+	}
+	~Emulation()
+	{
+		if( handle )
+			handle.destroy();
+	}
+
+	// false once the emulation has ended
+	bool next()
+	{
+		if( !handle || handle.done() )
+			return false;
+
+		handle.resume();
+		return !handle.done();
+	}
+
+	const StepEvent& event() const { return handle.promise().current; }
+
+private:
+	explicit Emulation( Handle new_handle ) : handle( new_handle ) {}
+
+	Handle handle;
+};
+
+/*
+	Runs frames of cycles_per_frame instructions, like Chip8::run_frame(). A halted
+	debugger is reported as a BREAKPOINT event; an instruction held back by a breakpoint
+	is retried on the next resume, so the host resumes the debugger before calling next().
+*/
+Emulation emulate( Chip8& machine, unsigned cycles_per_frame, uint32_t frame_limit = UINT32_MAX );
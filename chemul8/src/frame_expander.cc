@@ -0,0 +1,85 @@
+/*
+ * frame_expander.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "frame_expander.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+FrameExpander::FrameExpander( unsigned scale )
+	: scale( std::max( scale, 1U ) )
+{
+}
+
+void FrameExpander::to_luma( const uint8_t * display, uint8_t * pixels, uint8_t foreground_luma,
+							 uint8_t background_luma ) const
+{
+	const size_t row_pixels = width();
+
+	for( unsigned y = 0; y < display_height; ++y ) {
+		uint8_t * first_line = pixels + size_t( y ) * scale * row_pixels;
+
+		expand_row_luma( display + y * display_width / 8, first_line, foreground_luma, background_luma );
+
+		for( unsigned line = 1; line < scale; ++line )
+			std::memcpy( first_line + line * row_pixels, first_line, row_pixels );
+	}
+}
+
+/*
+	The SSE2 path broadcasts two display bytes across a register, isolates one bit per
+	lane and turns the comparison result into a select mask, giving 16 luma pixels per
+	instruction group. Scaled output widens each pixel afterwards.
+*/
+void FrameExpander::expand_row_luma( const uint8_t * row, uint8_t * pixels, uint8_t foreground_luma,
+									 uint8_t background_luma ) const
+{
+	uint8_t line[display_width];
+
+#if defined( __SSE2__ )
+	const __m128i fg = _mm_set1_epi8( static_cast<char>( foreground_luma ) );
+	const __m128i bg = _mm_set1_epi8( static_cast<char>( background_luma ) );
+	const __m128i bits = _mm_set_epi8( char( 0x80 ), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+									   char( 0x80 ), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 );
+
+	for( unsigned byte = 0; byte < display_width / 8; byte += 2 ) {
+		const __m128i value = _mm_unpacklo_epi64( _mm_set1_epi8( static_cast<char>( row[byte] ) ),
+												  _mm_set1_epi8( static_cast<char>( row[byte + 1] ) ) );
+		const __m128i mask = _mm_cmpeq_epi8( _mm_and_si128( value, bits ), bits );
+
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( &line[byte * 8] ),
+						  _mm_or_si128( _mm_and_si128( mask, fg ), _mm_andnot_si128( mask, bg ) ) );
+	}
+#else
+	for( unsigned x = 0; x < display_width; ++x )
+		line[x] = ( ( row[x / 8] >> ( x % 8 ) ) & 0x01 ) ? foreground_luma : background_luma;
+#endif
+
+	if( scale == 1 ) {
+		std::memcpy( pixels, line, sizeof( line ) );
+		return;
+	}
+
+	for( unsigned x = 0; x < display_width; ++x )
+		std::memset( pixels + x * scale, line[x], scale );
+}
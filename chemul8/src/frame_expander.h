@@ -0,0 +1,49 @@
+/*
+ * frame_expander.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+	Turns the 1bpp display buffer (64 x 32, least significant bit is the leftmost pixel)
+	into 8-bit luma pixels, each display pixel becoming a scale x scale block.
+*/
+class FrameExpander
+{
+public:
+	static constexpr unsigned display_width = 64;
+	static constexpr unsigned display_height = 32;
+
+	explicit FrameExpander( unsigned scale = 1 );
+
+	unsigned width() const { return display_width * scale; }
+	unsigned height() const { return display_height * scale; }
+
+	// One byte per pixel, foreground_luma or background_luma
+	void to_luma( const uint8_t * display, uint8_t * pixels, uint8_t foreground_luma = 235,
+				  uint8_t background_luma = 16 ) const;
+
+private:
+	unsigned scale;
+
+	void expand_row_luma( const uint8_t * row, uint8_t * pixels, uint8_t foreground_luma, uint8_t background_luma ) const;
+};
@@ -0,0 +1,64 @@
+/*
+ * hash_log.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "hash_log.h"
+
+#include <algorithm>
+#include <iomanip>
+
+void HashLogWriter::record( uint64_t frame_no, uint64_t hash )
+{
+	auto flags = os.flags();
+	auto fill = os.fill();
+
+	os << std::dec << frame_no << ' ' << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash << '\n';
+
+	os.fill( fill );
+	os.flags( flags );
+
+	frame = frame_no + 1;
+}
+
+bool read_hash_entry( std::istream& is, HashLogEntry& entry )
+{
+	return static_cast<bool>( is >> std::dec >> entry.frame >> std::hex >> entry.hash );
+}
+
+std::optional<Divergence> find_first_divergence( std::istream& expected, std::istream& actual )
+{
+	HashLogEntry lhs;
+	HashLogEntry rhs;
+
+	while( true ) {
+		const bool have_lhs = read_hash_entry( expected, lhs );
+		const bool have_rhs = read_hash_entry( actual, rhs );
+
+		if( !have_lhs && !have_rhs )
+			return std::nullopt;
+
+		if( !have_lhs )
+			return Divergence { rhs.frame, std::nullopt, rhs.hash };
+
+		if( !have_rhs )
+			return Divergence { lhs.frame, lhs.hash, std::nullopt };
+
+		if( lhs.frame != rhs.frame || lhs.hash != rhs.hash )
+			return Divergence { std::min( lhs.frame, rhs.frame ), lhs.hash, rhs.hash };
+	}
+}
@@ -0,0 +1,59 @@
+/*
+ * hash_log.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+
+/*
+	A hash log holds one line per frame, "<frame> <hash as 16 hex digits>".
+	Two logs of the same ROM and input are compared line by line without loading either.
+*/
+class HashLogWriter
+{
+public:
+	explicit HashLogWriter( std::ostream& os ) : os( os ) {}
+
+	void record( uint64_t hash ) { record( frame, hash ); }
+	void record( uint64_t frame_no, uint64_t hash );
+
+private:
+	std::ostream& os;
+	uint64_t frame = 0;
+};
+
+struct HashLogEntry
+{
+	uint64_t frame;
+	uint64_t hash;
+};
+
+bool read_hash_entry( std::istream& is, HashLogEntry& entry );
+
+struct Divergence
+{
+	uint64_t frame;
+	std::optional<uint64_t> expected;	// empty when that log ended first
+	std::optional<uint64_t> actual;
+};
+
+std::optional<Divergence> find_first_divergence( std::istream& expected, std::istream& actual );
@@ -0,0 +1,63 @@
+/*
+ * host_protocol.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "host_protocol.h"
+
+#include <stdexcept>
+
+namespace HostProtocol {
+
+void append_message( std::vector<uint8_t>& out, eMessage type, const uint8_t * payload, size_t size )
+{
+	if( size > 0xFFFF )
+		throw std::length_error( "Host protocol payload too large" );
+
+	out.push_back( uint8_t( type ) );
+	out.push_back( size & 0xFF );
+	out.push_back( size >> 8 );
+	if( size )
+		out.insert( out.end(), payload, payload + size );
+}
+
+void MessageReader::feed( const uint8_t * data, size_t size )
+{
+	buffer.insert( buffer.end(), data, data + size );
+}
+
+bool MessageReader::next( Message& message )
+{
+	const size_t available = buffer.size() - read_pos;
+	const uint8_t * header = buffer.data() + read_pos;
+
+	if( available < header_size || available < header_size + ( header[1] | ( header[2] << 8 ) ) ) {
+		buffer.erase( buffer.begin(), buffer.begin() + read_pos );	// keep the partial message only
+		read_pos = 0;
+		return false;
+	}
+
+	const size_t length = header[1] | ( header[2] << 8 );
+
+	message.type = eMessage( header[0] );
+	message.payload.assign( header + header_size, header + header_size + length );
+	read_pos += header_size + length;
+
+	return true;
+}
+
+}
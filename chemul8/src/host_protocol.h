@@ -0,0 +1,63 @@
+/*
+ * host_protocol.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+	Messages exchanged between a session host and its clients over a stream socket.
+	Every message is a one byte type, a little endian 16-bit payload length and the payload.
+
+	client -> host   LOAD   program image, starts (or restarts) the session
+	                 KEYS   16-bit key mask, little endian
+	                 CLOSE  no payload
+	host -> client   FRAME  32-bit frame number, 256 display bytes, sound flag
+*/
+namespace HostProtocol {
+
+enum class eMessage : uint8_t { LOAD = 0x01, KEYS = 0x02, CLOSE = 0x03, FRAME = 0x81 };
+
+static constexpr size_t header_size = 3;
+static constexpr size_t frame_payload_size = 4 + 256 + 1;
+
+struct Message
+{
+	eMessage type;
+	std::vector<uint8_t> payload;
+};
+
+void append_message( std::vector<uint8_t>& out, eMessage type, const uint8_t * payload, size_t size );
+
+// Collects bytes from a stream and hands out the complete messages in them
+class MessageReader
+{
+public:
+	void feed( const uint8_t * data, size_t size );
+
+	bool next( Message& message );
+
+private:
+	std::vector<uint8_t> buffer;
+	size_t read_pos = 0;
+};
+
+}
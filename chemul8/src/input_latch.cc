@@ -0,0 +1,48 @@
+/*
+ * input_latch.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "input_latch.h"
+
+uint16_t InputLatch::latch( uint64_t now )
+{
+	uint16_t changed = 0;
+
+	for( const KeyEvent * event = events.front(); event && event->timestamp <= now; event = events.front() ) {
+		const uint16_t mask = 1 << ( event->key & 0x0F );
+		const uint16_t next = event->pressed ? ( keys | mask ) : ( keys & ~mask );
+
+		if( next == keys ) {				// repeat of the current state
+			events.pop();
+			continue;
+		}
+
+		if( changed & mask )				// second edge of this key, leave it for the next frame
+			break;
+
+		keys = next;
+		changed |= mask;
+
+		++latency.events;
+		latency.total_ns += now - event->timestamp;
+
+		events.pop();
+	}
+
+	return keys;
+}
@@ -0,0 +1,60 @@
+/*
+ * input_latch.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include "spsc_ring.h"
+
+struct KeyEvent
+{
+	uint64_t timestamp;		// nanoseconds, same clock as the one passed to latch()
+	uint8_t key;			// 0x0 - 0xF
+	bool pressed;
+};
+
+/*
+	Key transitions are posted by the thread that reads the host input and applied
+	by the emulator at frame boundaries. A latch never applies two transitions of the
+	same key, so a press and release inside one frame show up as two edges and Fx0A
+	does not miss them.
+*/
+class InputLatch
+{
+public:
+	bool post( const KeyEvent& event ) { return events.push( event ); }
+
+	uint16_t latch( uint64_t now );
+	uint16_t get_keys() const { return keys; }
+
+	// Transitions applied since the last call and their summed time in the queue
+	struct Latency {
+		uint64_t events = 0;
+		uint64_t total_ns = 0;
+	};
+
+	Latency take_latency() { return std::exchange( latency, {} ); }
+
+private:
+	SPSCRing<KeyEvent, 256> events;
+	uint16_t keys = 0;
+	Latency latency;
+};
@@ -0,0 +1,42 @@
+/*
+ * offscreen_backend.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "offscreen_backend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+void OffscreenBackend::draw_buffer( const uint8_t *buffer, uint16_t size )
+{
+	std::copy_n( buffer, std::min<size_t>( size, sizeof( display ) ), display );
+	++frames_drawn;
+}
+
+// Nothing blocks on vsync here, so the poll keeps the UI loop from spinning a core
+void OffscreenBackend::check_events( InputLatch & )
+{
+	last_event = Events::NO_EVENT;
+	std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+}
+
+uint64_t OffscreenBackend::get_ticks() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
@@ -0,0 +1,47 @@
+/*
+ * offscreen_backend.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "backend.h"
+
+/*
+	Keeps the display in memory and never touches a window, for batch runs, benchmarks
+	and machines without a display. There is no keyboard, so the emulator only stops
+	when it is told to by something else. chemul8 runs it unpaced, frames back to back.
+*/
+class OffscreenBackend : public Backend
+{
+public:
+	void make_sound() override { ++sounds; }
+	void draw_buffer( const uint8_t *buffer, uint16_t size ) override;
+	void check_events( InputLatch &input ) override;
+	uint64_t get_ticks() const override;
+
+	const uint8_t * get_display() const { return display; }
+	uint64_t get_frames_drawn() const { return frames_drawn; }
+	uint64_t get_sounds() const { return sounds; }
+
+private:
+	uint8_t display[256] {};
+	uint64_t frames_drawn = 0;
+	uint64_t sounds = 0;
+};
@@ -0,0 +1,71 @@
+/*
+ * paged_memory.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "paged_memory.h"
+
+#include <algorithm>
+#include <cstring>
+
+PagedMemory& PagedMemory::operator=( const PagedMemory& other )
+{
+	if( this != &other )
+		copy_from( other );
+
+	return *this;
+}
+
+PagedMemory::Page& PagedMemory::allocate( unsigned index )
+{
+	if( !pages[index] )
+		pages[index] = std::make_unique<Page>();
+
+	return *pages[index];
+}
+
+void PagedMemory::touch( unsigned index )
+{
+	allocate( index ).fill( 0 );
+	present |= 1 << index;
+}
+
+void PagedMemory::write( uint16_t address, const uint8_t * data, size_t size )
+{
+	size = std::min<size_t>( size, page_count * page_size - address );
+
+	while( size ) {
+		const size_t offset = address & ( page_size - 1 );
+		const size_t chunk = std::min( size, page_size - offset );
+
+		std::memcpy( &at( address ), data, chunk );
+
+		address += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+}
+
+// Pages absent in other become absent here, without giving up their storage
+void PagedMemory::copy_from( const PagedMemory& other )
+{
+	for( unsigned index = 0; index < page_count; ++index )
+		if( ( other.present >> index ) & 0x01 )
+			allocate( index ) = *other.pages[index];
+
+	present = other.present;
+}
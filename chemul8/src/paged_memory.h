@@ -0,0 +1,77 @@
+/*
+ * paged_memory.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*
+	The 64 KB XO-CHIP address space as sixteen 4 KB pages. A page gets its storage on
+	the first write and reads as zero until then. clear() only forgets which pages are
+	present; their storage is kept and zero-filled when the page is next written.
+*/
+class PagedMemory
+{
+public:
+	static constexpr unsigned page_shift = 12;
+	static constexpr size_t page_size = size_t( 1 ) << page_shift;
+	static constexpr unsigned page_count = 16;
+
+	PagedMemory() = default;
+	PagedMemory( const PagedMemory& other ) { copy_from( other ); }
+	PagedMemory& operator=( const PagedMemory& other );
+	PagedMemory( PagedMemory&& ) noexcept = default;
+	PagedMemory& operator=( PagedMemory&& ) noexcept = default;
+
+	uint8_t get( uint16_t address ) const
+	{
+		const unsigned index = address >> page_shift;
+		return ( ( present >> index ) & 0x01 ) ? ( *pages[index] )[address & ( page_size - 1 )] : 0;
+	}
+
+	uint8_t& at( uint16_t address )
+	{
+		const unsigned index = address >> page_shift;
+
+		if( !( ( present >> index ) & 0x01 ) )
+			touch( index );
+
+		return ( *pages[index] )[address & ( page_size - 1 )];
+	}
+
+	void write( uint16_t address, const uint8_t * data, size_t size );
+	void clear() { present = 0; }
+
+	void copy_from( const PagedMemory& other );
+
+	uint16_t present_pages() const { return present; }
+	const uint8_t * page_data( unsigned index ) const { return ( ( present >> index ) & 0x01 ) ? pages[index]->data() : nullptr; }
+
+private:
+	using Page = std::array<uint8_t, page_size>;
+
+	std::array<std::unique_ptr<Page>, page_count> pages;
+	uint16_t present = 0;
+
+	Page& allocate( unsigned index );
+	void touch( unsigned index );
+};
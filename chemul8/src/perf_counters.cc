@@ -0,0 +1,123 @@
+/*
+ * perf_counters.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static void add( std::atomic<uint64_t>& counter, uint64_t value )
+{
+	counter.store( counter.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+}
+
+static uint64_t get( const std::atomic<uint64_t>& counter )
+{
+	return counter.load( std::memory_order_relaxed );
+}
+
+void PerfCounters::add_frame( uint64_t frame_time, uint64_t executed, uint64_t drawn )
+{
+	add( frames, 1 );
+	add( frame_ns, frame_time );
+	add( instructions, executed );
+	add( draws, drawn );
+	add( frame_histogram[std::min<uint64_t>( frame_time / 1000000, histogram_buckets - 1 )], 1 );
+}
+
+void PerfCounters::add_input( uint64_t events, uint64_t latency )
+{
+	add( input_events, events );
+	add( input_latency_ns, latency );
+}
+
+void PerfCounters::add_render( uint64_t render_time, uint64_t dropped )
+{
+	add( renders, 1 );
+	add( render_ns, render_time );
+	add( dropped_frames, dropped );
+}
+
+PerfCounters::Totals PerfCounters::read() const
+{
+	Totals totals;
+
+	totals.frames = get( frames );
+	totals.frame_ns = get( frame_ns );
+	totals.instructions = get( instructions );
+	totals.draws = get( draws );
+	totals.input_events = get( input_events );
+	totals.input_latency_ns = get( input_latency_ns );
+	totals.renders = get( renders );
+	totals.render_ns = get( render_ns );
+	totals.dropped_frames = get( dropped_frames );
+
+	for( unsigned bucket = 0; bucket < histogram_buckets; ++bucket )
+		totals.frame_histogram[bucket] = get( frame_histogram[bucket] );
+
+	return totals;
+}
+
+static double per( uint64_t amount, uint64_t count ) { return count ? double( amount ) / count : 0.0; }
+
+std::vector<std::string> describe_rates( const PerfCounters::Totals& earlier, const PerfCounters::Totals& later )
+{
+	const uint64_t frames = later.frames - earlier.frames;
+	const uint64_t elapsed = later.frame_ns - earlier.frame_ns;
+	const uint64_t renders = later.renders - earlier.renders;
+	char line[64];
+	std::vector<std::string> lines;
+
+	std::snprintf( line, sizeof( line ), "IPS    %.0f", per( later.instructions - earlier.instructions, elapsed ) * 1e9 );
+	lines.push_back( line );
+
+	std::snprintf( line, sizeof( line ), "FRAME  %.2f ms", per( elapsed, frames ) / 1e6 );
+	lines.push_back( line );
+
+	std::snprintf( line, sizeof( line ), "DRW    %.1f / frame", per( later.draws - earlier.draws, frames ) );
+	lines.push_back( line );
+
+	std::snprintf( line, sizeof( line ), "INPUT  %.2f ms",
+				   per( later.input_latency_ns - earlier.input_latency_ns, later.input_events - earlier.input_events ) / 1e6 );
+	lines.push_back( line );
+
+	std::snprintf( line, sizeof( line ), "RENDER %.2f ms", per( later.render_ns - earlier.render_ns, renders ) / 1e6 );
+	lines.push_back( line );
+
+	std::snprintf( line, sizeof( line ), "DROP   %llu", (unsigned long long)( later.dropped_frames - earlier.dropped_frames ) );
+	lines.push_back( line );
+
+	return lines;
+}
+
+void print_report( std::ostream& os, const PerfCounters::Totals& totals )
+{
+	for( const std::string& line : describe_rates( PerfCounters::Totals {}, totals ) )
+		os << line << '\n';
+
+	os << "Frame time histogram (ms):\n";
+
+	for( unsigned bucket = 0; bucket < PerfCounters::histogram_buckets; ++bucket ) {
+		if( !totals.frame_histogram[bucket] )
+			continue;
+
+		const bool last = ( bucket == PerfCounters::histogram_buckets - 1 );
+		os << "    " << ( last ? ">= " : "" ) << bucket << " : " << totals.frame_histogram[bucket] << '\n';
+	}
+}
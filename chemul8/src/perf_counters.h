@@ -0,0 +1,82 @@
+/*
+ * perf_counters.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+	Performance counters for the interactive emulator. Every counter has exactly one
+	writing thread, so an update is a relaxed load and store rather than a locked
+	read-modify-write; the CPU thread adds once per frame and any thread may read().
+*/
+class PerfCounters
+{
+public:
+	static constexpr unsigned histogram_buckets = 32;	// 1 ms each, the last one takes everything longer
+
+	struct Totals {
+		uint64_t frames = 0;
+		uint64_t frame_ns = 0;
+		uint64_t instructions = 0;
+		uint64_t draws = 0;
+		uint64_t input_events = 0;
+		uint64_t input_latency_ns = 0;
+		uint64_t renders = 0;
+		uint64_t render_ns = 0;
+		uint64_t dropped_frames = 0;
+		std::array<uint64_t, histogram_buckets> frame_histogram {};
+	};
+
+	// CPU thread
+	void add_frame( uint64_t frame_ns, uint64_t instructions, uint64_t draws );
+	void add_input( uint64_t events, uint64_t latency_ns );
+
+	// UI thread
+	void add_render( uint64_t render_ns, uint64_t dropped_frames );
+
+	Totals read() const;
+
+private:
+	using Counter = std::atomic<uint64_t>;
+
+	// CPU thread
+	Counter frames { 0 };
+	Counter frame_ns { 0 };
+	Counter instructions { 0 };
+	Counter draws { 0 };
+	Counter input_events { 0 };
+	Counter input_latency_ns { 0 };
+	std::array<Counter, histogram_buckets> frame_histogram {};
+
+	// UI thread, kept off the CPU thread's cache line
+	alignas( 64 ) Counter renders { 0 };
+	Counter render_ns { 0 };
+	Counter dropped_frames { 0 };
+};
+
+// One line each for IPS, frame time, draws, input latency and render time between two readings
+std::vector<std::string> describe_rates( const PerfCounters::Totals& earlier, const PerfCounters::Totals& later );
+
+void print_report( std::ostream& os, const PerfCounters::Totals& totals );
@@ -0,0 +1,95 @@
+/*
+ * rollback.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "rollback.h"
+
+#include <algorithm>
+
+RollbackEngine::RollbackEngine( Chip8& machine, Config config )
+	: machine( machine ), configuration( config ),
+	  predictor( []( unsigned, uint32_t, uint16_t last_confirmed ) { return last_confirmed; } ),
+	  slots( config.max_rollback + 1 ), inputs( 2 * slots.size() * config.players ),
+	  next_confirmed( config.players, 0 ), last_confirmed( config.players, 0 )
+{
+	for( Slot& slot : slots )
+		slot.used_keys.resize( config.players );
+}
+
+bool RollbackEngine::add_input( unsigned player, uint32_t at, uint16_t keys )
+{
+	if( player >= configuration.players || at != next_confirmed[player] || at >= frame + slots.size() )
+		return false;
+
+	input_of( player, at ) = { at, keys };
+	next_confirmed[player] = at + 1;
+	last_confirmed[player] = keys;
+
+	if( at < frame && slots[at % slots.size()].used_keys[player] != keys )
+		rollback_from = std::min( rollback_from, at );
+
+	return true;
+}
+
+uint32_t RollbackEngine::get_confirmed_frame() const
+{
+	return *std::min_element( next_confirmed.begin(), next_confirmed.end() );
+}
+
+bool RollbackEngine::advance()
+{
+	if( frame - get_confirmed_frame() >= configuration.max_rollback )
+		return false;
+
+	settle();
+	simulate( frame++ );
+
+	return true;
+}
+
+void RollbackEngine::settle()
+{
+	if( rollback_from >= frame )
+		return;
+
+	++rollbacks;
+	machine.restore_state( slots[rollback_from % slots.size()].state );
+
+	for( uint32_t at = rollback_from; at < frame; ++at, ++resimulated_frames )
+		simulate( at );
+
+	rollback_from = UINT32_MAX;
+}
+
+void RollbackEngine::simulate( uint32_t at )
+{
+	Slot& slot = slots[at % slots.size()];
+	uint16_t keys = 0;
+
+	machine.save_state( slot.state );
+
+	for( unsigned player = 0; player < configuration.players; ++player ) {
+		const Input& input = input_of( player, at );
+
+		slot.used_keys[player] = ( input.frame == at ) ? input.keys : predictor( player, at, last_confirmed[player] );
+		keys |= slot.used_keys[player];
+	}
+
+	machine.set_keys_state( keys );
+	machine.run_frame( configuration.cycles_per_frame );
+}
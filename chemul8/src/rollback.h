@@ -0,0 +1,97 @@
+/*
+ * rollback.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "chip8.h"
+
+/*
+	Rollback netplay for a single machine shared by several players. Frames are run
+	as soon as the local input is known, with predicted input for players whose input
+	has not arrived. When a late input differs from the prediction the machine goes
+	back to the snapshot of that frame and runs forward again with what is now known.
+
+	The keys of all players are or-ed together, each player is expected to use their own keys.
+	Input of a player has to be added in frame order.
+*/
+class RollbackEngine
+{
+public:
+	struct Config {
+		unsigned players = 2;
+		unsigned cycles_per_frame = 10;
+		unsigned max_rollback = 8;		// frames that may run ahead of the confirmed input
+	};
+
+	using Predictor = std::function<uint16_t( unsigned player, uint32_t frame, uint16_t last_confirmed )>;
+
+	RollbackEngine( Chip8& machine, Config config );
+
+	void set_predictor( Predictor new_predictor ) { predictor = std::move( new_predictor ); }
+
+	// false when the frame is out of order or outside the window the engine can still correct
+	bool add_input( unsigned player, uint32_t frame, uint16_t keys );
+
+	// Runs the next frame; false when it would run further ahead of the confirmed input than max_rollback
+	bool advance();
+
+	// Applies the corrections added since the last advance() without running a new frame
+	void settle();
+
+	uint32_t get_frame() const { return frame; }
+	uint32_t get_confirmed_frame() const;
+
+	uint64_t get_rollbacks() const { return rollbacks; }
+	uint64_t get_resimulated_frames() const { return resimulated_frames; }
+
+private:
+	struct Slot
+	{
+		Chip8::Snapshot state;				// machine state at the start of the frame
+		std::vector<uint16_t> used_keys;	// per player, confirmed or predicted
+	};
+
+	struct Input
+	{
+		uint32_t frame = UINT32_MAX;
+		uint16_t keys = 0;
+	};
+
+	Chip8& machine;
+	Config configuration;
+	Predictor predictor;
+
+	uint32_t frame = 0;
+	uint32_t rollback_from = UINT32_MAX;
+
+	std::vector<Slot> slots;				// ring of max_rollback + 1 frames
+	std::vector<Input> inputs;				// ring of 2 * slots.size() frames per player
+	std::vector<uint32_t> next_confirmed;	// per player
+	std::vector<uint16_t> last_confirmed;	// per player
+
+	uint64_t rollbacks = 0;
+	uint64_t resimulated_frames = 0;
+
+	Input& input_of( unsigned player, uint32_t at ) { return inputs[( at % ( 2 * slots.size() ) ) * configuration.players + player]; }
+	void simulate( uint32_t at );
+};
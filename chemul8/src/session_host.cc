@@ -0,0 +1,260 @@
+/*
+ * session_host.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "session_host.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace HostProtocol;
+
+SessionHost::SessionHost( Config config )
+	: configuration( config ), pool( config.threads )
+{
+}
+
+SessionHost::~SessionHost()
+{
+	for( auto& session : sessions )
+		::close( session->fd );
+}
+
+void SessionHost::add_session( int fd, Clock::time_point now )
+{
+	sessions.push_back( std::make_unique<Session>() );
+
+	Session& session = *sessions.back();
+	session.fd = fd;
+	session.deadline = now;
+
+	schedule.push( { now, &session } );
+}
+
+void SessionHost::read_input()
+{
+	uint8_t buffer[4096];
+	Message message;
+
+	for( auto& session : sessions ) {
+		while( !session->closed ) {
+			ssize_t received = ::recv( session->fd, buffer, sizeof( buffer ), MSG_DONTWAIT );
+
+			if( received > 0 ) {
+				session->reader.feed( buffer, received );
+				continue;
+			}
+
+			if( received == 0 || ( errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR ) )
+				session->closed = true;
+
+			if( received < 0 && errno == EINTR )
+				continue;
+
+			break;
+		}
+
+		while( !session->closed && session->reader.next( message ) )
+			handle_message( *session, message );
+	}
+
+	drop_closed();
+}
+
+void SessionHost::handle_message( Session& session, const Message& message )
+{
+	switch( message.type ) {
+	case eMessage::LOAD:
+		session.device.set_program( message.payload.data(), message.payload.size() );
+		session.device.set_quirk_type( Chip8::eQuirkType::CHIP8 );
+		session.keys = 0;
+		session.frame_no = 0;
+		session.running = true;
+		break;
+
+	case eMessage::KEYS:
+		if( message.payload.size() >= 2 )
+			session.keys = message.payload[0] | ( message.payload[1] << 8 );
+		break;
+
+	case eMessage::CLOSE:
+		session.closed = true;
+		break;
+
+	default:						// unknown messages are ignored, newer clients may send more
+		break;
+	}
+}
+
+void SessionHost::run_due( Clock::time_point now )
+{
+	due.clear();
+
+	while( !schedule.empty() && schedule.top().first <= now ) {
+		due.push_back( schedule.top().second );
+		schedule.pop();
+	}
+
+	pool.parallel_for( due.size(), [this]( size_t index ) {
+		Session& session = *due[index];
+
+		if( !session.running || session.closed )
+			return;
+
+		session.device.set_keys_state( session.keys );
+		session.device.run_frame( configuration.cycles_per_frame );
+	} );
+
+	for( Session * session : due ) {
+		if( session->running && !session->closed )
+			send_frame( *session );
+
+		// a session that fell more than a frame behind skips ahead instead of bursting
+		session->deadline += configuration.frame_period;
+		if( session->deadline + configuration.frame_period <= now )
+			session->deadline = now + configuration.frame_period;
+
+		schedule.push( { session->deadline, session } );
+	}
+
+	drop_closed();
+}
+
+SessionHost::Clock::time_point SessionHost::next_deadline() const
+{
+	return schedule.empty() ? Clock::time_point::max() : schedule.top().first;
+}
+
+void SessionHost::send_frame( Session& session )
+{
+	if( !session.pending.empty() ) {
+		++session.dropped_frames;
+		flush( session );
+		return;
+	}
+
+	uint8_t payload[frame_payload_size];
+
+	payload[0] = session.frame_no;
+	payload[1] = session.frame_no >> 8;
+	payload[2] = session.frame_no >> 16;
+	payload[3] = session.frame_no >> 24;
+	std::memcpy( &payload[4], session.device.get_display_buffer(), 256 );
+	payload[260] = session.device.get_sound_active() ? 1 : 0;
+
+	++session.frame_no;
+
+	append_message( session.pending, eMessage::FRAME, payload, sizeof( payload ) );
+	flush( session );
+}
+
+void SessionHost::flush( Session& session )
+{
+	while( !session.pending.empty() ) {
+		ssize_t sent = ::send( session.fd, session.pending.data(), session.pending.size(), MSG_DONTWAIT | MSG_NOSIGNAL );
+
+		if( sent > 0 ) {
+			session.pending.erase( session.pending.begin(), session.pending.begin() + sent );
+			continue;
+		}
+
+		if( sent < 0 && errno == EINTR )
+			continue;
+
+		if( sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK )
+			session.closed = true;
+
+		return;
+	}
+}
+
+void SessionHost::drop_closed()
+{
+	auto first_closed = std::partition( sessions.begin(), sessions.end(),
+										[]( const std::unique_ptr<Session>& session ) { return !session->closed; } );
+
+	if( first_closed == sessions.end() )
+		return;
+
+	for( auto it = first_closed; it != sessions.end(); ++it )
+		::close( ( *it )->fd );
+
+	sessions.erase( first_closed, sessions.end() );
+
+	// the schedule holds pointers into the sessions, rebuild it from the survivors
+	schedule = {};
+	for( auto& session : sessions )
+		schedule.push( { session->deadline, session.get() } );
+}
+
+void SessionHost::serve( const std::string& socket_path, const std::atomic<bool>& stop )
+{
+	sockaddr_un address {};
+	address.sun_family = AF_UNIX;
+
+	if( socket_path.size() >= sizeof( address.sun_path ) )
+		throw std::runtime_error( "Socket path too long: " + socket_path );
+
+	std::memcpy( address.sun_path, socket_path.c_str(), socket_path.size() + 1 );
+
+	int listener = ::socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+	if( listener < 0 )
+		throw std::runtime_error( std::string( "socket: " ) + std::strerror( errno ) );
+
+	::unlink( socket_path.c_str() );
+
+	if( ::bind( listener, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) < 0 || ::listen( listener, 64 ) < 0 ) {
+		std::string error = std::strerror( errno );
+		::close( listener );
+		throw std::runtime_error( "Cannot listen on " + socket_path + ": " + error );
+	}
+
+	std::vector<pollfd> watched;
+
+	while( !stop ) {
+		watched.assign( 1, { listener, POLLIN, 0 } );
+		for( auto& session : sessions )
+			watched.push_back( { session->fd, POLLIN, 0 } );
+
+		// wake for the next frame, and at least every 100ms to notice stop
+		auto wait = std::chrono::duration_cast<std::chrono::milliseconds>( next_deadline() - Clock::now() ).count();
+		int timeout = int( std::clamp<decltype( wait )>( wait, 0, 100 ) );
+
+		if( ::poll( watched.data(), watched.size(), timeout ) < 0 && errno != EINTR )
+			break;
+
+		if( watched[0].revents & POLLIN ) {
+			int client;
+			while( ( client = ::accept4( listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC ) ) >= 0 )
+				add_session( client, Clock::now() );
+		}
+
+		read_input();
+		run_due( Clock::now() );
+	}
+
+	::close( listener );
+	::unlink( socket_path.c_str() );
+}
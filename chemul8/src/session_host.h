@@ -0,0 +1,97 @@
+/*
+ * session_host.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chip8.h"
+#include "host_protocol.h"
+#include "worker_pool.h"
+
+/*
+	Runs many headless Chip8 sessions in one process. Each connected client is a
+	session; sessions are run a frame at a time when their deadline comes up, the
+	due ones together on the worker pool, and the finished frame is sent back.
+	A client that does not keep up with its socket misses frames instead of stalling the host.
+*/
+class SessionHost
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Config {
+		unsigned threads = 0;
+		unsigned cycles_per_frame = 10;
+		Clock::duration frame_period = std::chrono::nanoseconds( 16666667 );
+	};
+
+	explicit SessionHost( Config config );
+	~SessionHost();
+
+	SessionHost( const SessionHost& ) = delete;
+	SessionHost& operator=( const SessionHost& ) = delete;
+
+	// Takes ownership of a connected, non-blocking stream socket
+	void add_session( int fd, Clock::time_point now );
+	size_t session_count() const { return sessions.size(); }
+
+	void read_input();
+	void run_due( Clock::time_point now );
+	Clock::time_point next_deadline() const;
+
+	// Accepts clients on a Unix socket at socket_path until stop is set
+	void serve( const std::string& socket_path, const std::atomic<bool>& stop );
+
+private:
+	struct Session
+	{
+		int fd;
+		Chip8 device;
+		HostProtocol::MessageReader reader;
+		uint16_t keys = 0;
+		bool running = false;
+		bool closed = false;
+		uint32_t frame_no = 0;
+		uint64_t dropped_frames = 0;
+		Clock::time_point deadline;
+		std::vector<uint8_t> pending;		// bytes of the last frame the socket did not take yet
+	};
+
+	using Deadline = std::pair<Clock::time_point, Session *>;
+
+	Config configuration;
+	WorkerPool pool;
+
+	std::vector<std::unique_ptr<Session>> sessions;
+	std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> schedule;
+	std::vector<Session *> due;
+
+	void handle_message( Session& session, const HostProtocol::Message& message );
+	void send_frame( Session& session );
+	void flush( Session& session );
+	void drop_closed();
+};
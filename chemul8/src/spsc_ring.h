@@ -0,0 +1,67 @@
+/*
+ * spsc_ring.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/*
+	Single producer, single consumer queue. One thread may push() while another
+	uses front()/pop(); neither ever blocks or takes a lock.
+*/
+template<typename T, size_t Capacity>
+class SPSCRing
+{
+	static_assert( Capacity && ( Capacity & ( Capacity - 1 ) ) == 0, "Capacity must be a power of two" );
+
+public:
+	bool push( const T& item )
+	{
+		const size_t at = tail.load( std::memory_order_relaxed );
+
+		if( at - head.load( std::memory_order_acquire ) == Capacity )
+			return false;
+
+		slots[at & ( Capacity - 1 )] = item;
+		tail.store( at + 1, std::memory_order_release );
+		return true;
+	}
+
+	const T * front() const
+	{
+		const size_t at = head.load( std::memory_order_relaxed );
+
+		if( at == tail.load( std::memory_order_acquire ) )
+			return nullptr;
+
+		return &slots[at & ( Capacity - 1 )];
+	}
+
+	void pop() { head.store( head.load( std::memory_order_relaxed ) + 1, std::memory_order_release ); }
+
+	bool empty() const { return front() == nullptr; }
+
+private:
+	std::array<T, Capacity> slots {};
+
+	alignas( 64 ) std::atomic<size_t> head { 0 };		// written by the consumer
+	alignas( 64 ) std::atomic<size_t> tail { 0 };		// written by the producer
+};
@@ -0,0 +1,60 @@
+/*
+ * triple_buffer.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+	Hands the latest value from one writer thread to one reader thread without locks.
+	The writer fills back() and publishes it; the reader takes the newest published
+	value, so neither side ever waits for the other and stale frames are simply dropped.
+*/
+template<typename T>
+class TripleBuffer
+{
+public:
+	T& back() { return buffers[back_index]; }
+
+	void publish() { back_index = middle.exchange( back_index | fresh, std::memory_order_acq_rel ) & index_mask; }
+
+	// false when nothing was published since the last call; front() then still holds the previous value
+	bool acquire()
+	{
+		if( !( middle.load( std::memory_order_relaxed ) & fresh ) )
+			return false;
+
+		front_index = middle.exchange( front_index, std::memory_order_acq_rel ) & index_mask;
+		return true;
+	}
+
+	const T& front() const { return buffers[front_index]; }
+
+private:
+	static constexpr uint8_t index_mask = 0x03;
+	static constexpr uint8_t fresh = 0x04;
+
+	std::array<T, 3> buffers {};
+
+	uint8_t back_index = 0;								// writer only
+	alignas( 64 ) std::atomic<uint8_t> middle { 1 };
+	alignas( 64 ) uint8_t front_index = 2;				// reader only
+};
@@ -0,0 +1,97 @@
+/*
+ * vector_env.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "vector_env.h"
+
+VectorEnv::VectorEnv( Config config )
+	: configuration( config ), pool( config.threads ), machines( config.instances ),
+	  last_values( config.instances, 0.0F )
+{
+	for( size_t index = 0; index < machines.size(); ++index )
+		machines[index].set_seed( configuration.seed + index );
+}
+
+void VectorEnv::reset( const uint8_t * program, size_t size )
+{
+	program_image.assign( program, program + size );
+
+	pool.parallel_for( machines.size(), [this]( size_t index ) { reset_instance( index ); } );
+}
+
+void VectorEnv::reset_instance( size_t index )
+{
+	Chip8& machine = machines[index];
+
+	machine.set_program( program_image.data(), program_image.size() );
+	machine.set_quirk_type( configuration.quirk_type );
+
+	last_values[index] = sample_watches( index );
+}
+
+void VectorEnv::step( const uint16_t * actions, uint8_t * observations, float * rewards )
+{
+	pool.parallel_for( machines.size(), [&]( size_t index ) {
+		Chip8& machine = machines[index];
+
+		machine.set_keys_state( actions[index] );
+		machine.run_frame( configuration.cycles_per_frame );
+
+		write_observation( machine, observations + index * observation_size );
+
+		const float value = sample_watches( index );
+		rewards[index] = value - last_values[index];
+		last_values[index] = value;
+	} );
+}
+
+float VectorEnv::watched_value( const Chip8& machine, const RewardWatch& watch ) const
+{
+	switch( watch.encoding ) {
+	case RewardWatch::eEncoding::BYTE:
+		return machine.get_byte( watch.address );
+
+	case RewardWatch::eEncoding::WORD:
+		return ( machine.get_byte( watch.address ) << 8 ) | machine.get_byte( watch.address + 1 );
+
+	case RewardWatch::eEncoding::BCD:
+		return machine.get_byte( watch.address ) * 100 + machine.get_byte( watch.address + 1 ) * 10 +
+			   machine.get_byte( watch.address + 2 );
+	}
+
+	return 0.0F;
+}
+
+float VectorEnv::sample_watches( size_t index ) const
+{
+	float total = 0.0F;
+
+	for( const auto& watch : watches )
+		total += watch.scale * watched_value( machines[index], watch );
+
+	return total;
+}
+
+void VectorEnv::write_observation( const Chip8& machine, uint8_t * observation ) const
+{
+	const uint8_t * display = machine.get_display_buffer();
+
+	for( size_t byte = 0; byte < observation_size / 8; ++byte )
+		for( unsigned bit = 0; bit < 8; ++bit )
+			observation[byte * 8 + bit] = ( display[byte] >> bit ) & 0x01;
+}
@@ -0,0 +1,84 @@
+/*
+ * vector_env.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "chip8.h"
+#include "worker_pool.h"
+
+/*
+	Reward is derived from a value the ROM keeps in memory (usually the score).
+	Each frame the watched value is read again and the change, times scale, is
+	added to the reward of that instance.
+*/
+struct RewardWatch
+{
+	enum class eEncoding { BYTE, WORD, BCD };	// BCD: three digit bytes as written by Fx33
+
+	uint16_t address;
+	eEncoding encoding = eEncoding::BYTE;
+	float scale = 1.0F;
+};
+
+/*
+	N independent Chip8 machines stepped in lock step, one frame per step().
+	Observations are written as one byte (0 or 1) per pixel, instance after instance,
+	directly into the buffer handed to step().
+*/
+class VectorEnv
+{
+public:
+	struct Config {
+		size_t instances = 1;
+		unsigned cycles_per_frame = 10;
+		unsigned threads = 0;
+		uint32_t seed = 1;
+		Chip8::eQuirkType quirk_type = Chip8::eQuirkType::CHIP8;
+	};
+
+	static constexpr size_t observation_size = 64 * 32;
+
+	explicit VectorEnv( Config config );
+
+	void add_reward_watch( RewardWatch watch ) { watches.push_back( watch ); }
+
+	void reset( const uint8_t * program, size_t size );
+	void reset_instance( size_t index );
+
+	void step( const uint16_t * actions, uint8_t * observations, float * rewards );
+
+	size_t size() const { return configuration.instances; }
+
+private:
+	Config configuration;
+	WorkerPool pool;
+
+	std::vector<Chip8> machines;
+	std::vector<float> last_values;
+	std::vector<RewardWatch> watches;
+	std::vector<uint8_t> program_image;
+
+	float watched_value( const Chip8& machine, const RewardWatch& watch ) const;
+	float sample_watches( size_t index ) const;
+	void write_observation( const Chip8& machine, uint8_t * observation ) const;
+};
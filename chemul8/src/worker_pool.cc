@@ -0,0 +1,102 @@
+/*
+ * worker_pool.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool( unsigned thread_count )
+{
+	for( unsigned slot = 1; slot <= thread_count; ++slot )
+		threads.emplace_back( &WorkerPool::worker, this, slot );
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard( lock );
+		stopping = true;
+	}
+	work_ready.notify_all();
+
+	for( auto& thread : threads )
+		thread.join();
+}
+
+void WorkerPool::parallel_for( size_t count, const Job& job )
+{
+	if( threads.empty() || count < 2 ) {
+		for( size_t index = 0; index < count; ++index )
+			job( index );
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard( lock );
+		current_job = &job;
+		job_count = count;
+		busy = threads.size();
+		++generation;
+	}
+	work_ready.notify_all();
+
+	run_share( 0, job, count );
+
+	std::unique_lock<std::mutex> guard( lock );
+	work_done.wait( guard, [this]() { return busy == 0; } );
+	current_job = nullptr;
+}
+
+void WorkerPool::worker( unsigned slot )
+{
+	unsigned seen_generation = 0;
+
+	while( true ) {
+		const Job * job;
+		size_t count;
+
+		{
+			std::unique_lock<std::mutex> guard( lock );
+			work_ready.wait( guard, [&]() { return stopping || generation != seen_generation; } );
+
+			if( stopping )
+				return;
+
+			seen_generation = generation;
+			job = current_job;
+			count = job_count;
+		}
+
+		run_share( slot, *job, count );
+
+		{
+			std::lock_guard<std::mutex> guard( lock );
+			--busy;
+		}
+		work_done.notify_one();
+	}
+}
+
+// Contiguous slices keep each instance on one core from step to step
+void WorkerPool::run_share( unsigned slot, const Job& job, size_t count )
+{
+	const size_t first = count * slot / width();
+	const size_t last = count * ( slot + 1 ) / width();
+
+	for( size_t index = first; index < last; ++index )
+		job( index );
+}
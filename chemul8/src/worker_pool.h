@@ -0,0 +1,63 @@
+/*
+ * worker_pool.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+	A fixed set of threads that split an index range between them. The calling
+	thread takes a share of the work as well, so a pool of N threads runs N + 1 wide.
+*/
+class WorkerPool
+{
+public:
+	using Job = std::function<void( size_t index )>;
+
+	explicit WorkerPool( unsigned thread_count );
+	~WorkerPool();
+
+	WorkerPool( const WorkerPool& ) = delete;
+	WorkerPool& operator=( const WorkerPool& ) = delete;
+
+	void parallel_for( size_t count, const Job& job );
+
+	unsigned width() const { return threads.size() + 1; }
+
+private:
+	std::vector<std::thread> threads;
+
+	std::mutex lock;
+	std::condition_variable work_ready;
+	std::condition_variable work_done;
+
+	const Job * current_job = nullptr;
+	size_t job_count = 0;
+	unsigned generation = 0;
+	unsigned busy = 0;
+	bool stopping = false;
+
+	void worker( unsigned slot );
+	void run_share( unsigned slot, const Job& job, size_t count );
+};
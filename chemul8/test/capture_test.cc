@@ -0,0 +1,145 @@
+/*
+ * capture_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "capture.h"
+#include "frame_expander.h"
+
+class FrameExpanderTest : public ::testing::Test
+{
+protected:
+	uint8_t display[256] = {};
+
+	void SetUp() override
+	{
+		display[0] = 0x01;			// pixel (0,0)
+		display[7] = 0x80;			// pixel (63,0)
+		display[8 * 31 + 3] = 0x10;	// pixel (28,31)
+	}
+
+	// Reference expansion, one pixel at a time
+	bool lit( unsigned x, unsigned y ) const { return display[y * 8 + x / 8] & ( 1 << ( x % 8 ) ); }
+};
+
+TEST_F( FrameExpanderTest, LumaMatchesDisplay )
+{
+	for( unsigned scale : { 1u, 2u, 3u, 5u } ) {
+		FrameExpander expander( scale );
+		std::vector<uint8_t> pixels( expander.width() * expander.height() );
+
+		expander.to_luma( display, pixels.data() );
+
+		for( unsigned y = 0; y < expander.height(); ++y )
+			for( unsigned x = 0; x < expander.width(); ++x )
+				ASSERT_EQ( pixels[y * expander.width() + x], lit( x / scale, y / scale ) ? 235 : 16 )
+					<< "scale " << scale << " at " << x << "," << y;
+	}
+}
+
+TEST( PNGEncoderTest, WritesPaletteImage )
+{
+	const uint8_t pixels[16] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0 };
+
+	std::vector<uint8_t> png = PNGSequenceEncoder::encode( pixels, 8, 2, 0xFFFFFF, 0 );
+
+	const std::vector<uint8_t> signature = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	ASSERT_TRUE( std::equal( signature.begin(), signature.end(), png.begin() ) );
+
+	// IHDR: 8 x 2, bit depth 1, colour type 3; its CRC is fixed for these values
+	EXPECT_EQ( std::string( png.begin() + 12, png.begin() + 16 ), "IHDR" );
+	EXPECT_EQ( png[19], 8 );
+	EXPECT_EQ( png[23], 2 );
+	EXPECT_EQ( png[24], 1 );
+	EXPECT_EQ( png[25], 3 );
+
+	// scan lines follow the zlib header and the stored block header in IDAT
+	auto idat = std::search( png.begin(), png.end(), std::begin( "IDAT" ), std::begin( "IDAT" ) + 4 );
+	ASSERT_NE( idat, png.end() );
+
+	std::vector<uint8_t> scanlines( idat + 4 + 2 + 5, idat + 4 + 2 + 5 + 4 );
+	EXPECT_EQ( scanlines, ( std::vector<uint8_t> { 0, 0x80, 0, 0x40 } ) );
+
+	EXPECT_EQ( std::string( png.end() - 8, png.end() - 4 ), "IEND" );
+}
+
+class CountingEncoder : public FrameEncoder
+{
+public:
+	std::vector<uint8_t> first_bytes;
+
+	void write_frame( const uint8_t * display ) override { first_bytes.push_back( display[0] ); }
+};
+
+TEST( CaptureSinkTest, EncodesEveryFrameInOrder )
+{
+	auto encoder = std::make_unique<CountingEncoder>();
+	CountingEncoder * counting = encoder.get();
+
+	CaptureSink sink( std::move( encoder ), 4 );
+
+	uint8_t display[256] = {};
+	for( int frame = 0; frame < 100; ++frame ) {
+		display[0] = frame;
+		sink.submit( display );
+	}
+	sink.close();
+
+	EXPECT_EQ( sink.frames_written(), 100u );
+	ASSERT_EQ( counting->first_bytes.size(), 100u );
+	for( int frame = 0; frame < 100; ++frame )
+		EXPECT_EQ( counting->first_bytes[frame], frame );
+}
+
+// Fails on its third frame, as a full disk would
+class FailingEncoder : public FrameEncoder
+{
+public:
+	unsigned frames = 0;
+
+	void write_frame( const uint8_t * ) override
+	{
+		if( ++frames == 3 )
+			throw std::runtime_error( "disk full" );
+	}
+};
+
+TEST( CaptureSinkTest, EncoderErrorReachesTheCaller )
+{
+	CaptureSink sink( std::make_unique<FailingEncoder>(), 4 );
+
+	uint8_t display[256] = {};
+	unsigned reported = 0;
+
+	// the error surfaces in whichever call comes after the encoder thread failed
+	for( int frame = 0; frame < 5; ++frame )
+		try { sink.submit( display ); } catch( const std::runtime_error& ) { ++reported; }
+
+	try { sink.close(); } catch( const std::runtime_error& ) { ++reported; }
+
+	EXPECT_EQ( reported, 1u );
+	EXPECT_EQ( sink.frames_written(), 2u );
+
+	EXPECT_NO_THROW( sink.submit( display ) );		// frames after the error are dropped
+	EXPECT_NO_THROW( sink.close() );
+}
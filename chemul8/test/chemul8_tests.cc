@@ -18,6 +18,10 @@
  */
 #include <gtest/gtest.h>
 
+#include <vector>
+
+#include "chip8.h"
+
 class Chemul8Test : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -29,4 +33,148 @@ protected:
 
 TEST_F(Chemul8Test, aTest) {
     
-}
\ No newline at end of file
+}
+
+class SelfModifyingCodeTest : public ::testing::Test
+{
+protected:
+	// Patches the immediate of its own "ADD V1, #0" (0x208) to #5 with Fx55, then runs it
+	std::vector<uint8_t> program = {
+		0x60, 0x05,		// 0x200 LD V0, #5
+		0xA2, 0x09,		// 0x202 LD I, 0x209
+		0x12, 0x08,		// 0x204 JP 0x208
+		0x00, 0x00,		// 0x206
+		0x71, 0x00,		// 0x208 ADD V1, #0
+		0xF0, 0x55,		// 0x20A LD [I], V0
+		0x12, 0x08,		// 0x20C JP 0x208
+	};
+
+	Chip8 machine;
+
+	void SetUp() override
+	{
+		machine.set_program( program.data(), program.size() );
+		machine.set_quirk_type( Chip8::eQuirkType::SCHIP );
+	}
+};
+
+TEST_F( SelfModifyingCodeTest, store_into_fetched_code_is_reported )
+{
+	for( int tick = 0; tick < 7; ++tick )
+		machine.clock_tick();
+
+	EXPECT_EQ( machine.get_stats().instructions, 7 );
+	EXPECT_EQ( machine.get_stats().stores, 1 );
+	EXPECT_EQ( machine.get_stats().code_writes, 1 );
+	EXPECT_TRUE( machine.get_modified_code().test( 0x209 ) );
+	EXPECT_EQ( machine.get_register( 1 ), 5 );
+
+	EXPECT_EQ( machine.take_dirty_code_pages(), 1 << 2 );
+	EXPECT_EQ( machine.take_dirty_code_pages(), 0 );
+}
+
+TEST_F( SelfModifyingCodeTest, store_into_data_is_not_reported )
+{
+	for( int tick = 0; tick < 3; ++tick )
+		machine.clock_tick();
+
+	EXPECT_TRUE( machine.get_code_map().test( 0x204 ) );
+	EXPECT_FALSE( machine.get_code_map().test( 0x206 ) );
+	EXPECT_EQ( machine.get_stats().code_writes, 0 );
+}
+
+class StackCheckTest : public ::testing::Test
+{
+protected:
+	Chip8 machine;
+
+	void load( const std::vector<uint8_t>& program )
+	{
+		machine.set_program( program.data(), program.size() );
+		machine.set_quirk_type( Chip8::eQuirkType::CHIP8 );
+	}
+
+	void run( unsigned ticks )
+	{
+		for( unsigned tick = 0; tick < ticks; ++tick )
+			machine.clock_tick();
+	}
+};
+
+TEST_F( StackCheckTest, runaway_recursion_faults_at_capacity )
+{
+	load( {
+		0x22, 0x00,		// 0x200 CALL 0x200
+	} );
+
+	std::vector<uint8_t> below_stack;
+	for( uint16_t address = 0x70; address < 0x74; ++address )
+		below_stack.push_back( machine.get_byte( address ) );
+
+	run( Chip8::stack_capacity );
+	EXPECT_EQ( machine.get_fault(), Chip8::eFault::NONE );
+
+	run( 100 );
+	EXPECT_EQ( machine.get_fault(), Chip8::eFault::STACK_OVERFLOW );
+	EXPECT_EQ( machine.get_PC(), 0x200 );
+
+	for( uint16_t address = 0x70; address < 0x74; ++address )
+		EXPECT_EQ( machine.get_byte( address ), below_stack[address - 0x70] ) << "random generator state overwritten";
+}
+
+TEST_F( StackCheckTest, return_without_call_faults )
+{
+	load( {
+		0x00, 0xEE,		// 0x200 RET
+	} );
+
+	run( 3 );
+
+	EXPECT_EQ( machine.get_fault(), Chip8::eFault::STACK_UNDERFLOW );
+	EXPECT_EQ( machine.get_PC(), 0x200 );
+}
+
+// The proof only covers the loaded image; code the program writes itself gets the checks back
+TEST_F( StackCheckTest, stored_code_turns_checks_back_on )
+{
+	load( {
+		0x60, 0x22,		// 0x200 LD V0, #22
+		0x61, 0x0A,		// 0x202 LD V1, #0A
+		0xA2, 0x0A,		// 0x204 LD I, 0x20A
+		0xF1, 0x55,		// 0x206 LD [I], V1		stores CALL 0x20A at 0x20A
+		0x12, 0x0A,		// 0x208 JP 0x20A
+	} );
+	machine.set_stack_checks( false );
+
+	run( 5 + Chip8::stack_capacity + 100 );
+
+	EXPECT_EQ( machine.get_fault(), Chip8::eFault::STACK_OVERFLOW );
+	EXPECT_EQ( machine.get_PC(), 0x20A );
+}
+
+TEST_F( StackCheckTest, unchecked_stack_runs_proven_program_the_same )
+{
+	const std::vector<uint8_t> program = {
+		0x22, 0x06,		// 0x200 CALL 0x206
+		0x70, 0x01,		// 0x202 ADD V0, #1
+		0x12, 0x00,		// 0x204 JP 0x200
+		0x71, 0x02,		// 0x206 ADD V1, #2
+		0x00, 0xEE,		// 0x208 RET
+	};
+
+	Chip8 checked;
+	checked.set_program( program.data(), program.size() );
+	checked.set_quirk_type( Chip8::eQuirkType::CHIP8 );
+
+	load( program );
+	machine.set_stack_checks( false );
+
+	run( 200 );
+	for( int tick = 0; tick < 200; ++tick )
+		checked.clock_tick();
+
+	EXPECT_EQ( machine.get_register( 0 ), checked.get_register( 0 ) );
+	EXPECT_EQ( machine.get_register( 1 ), checked.get_register( 1 ) );
+	EXPECT_EQ( machine.get_PC(), checked.get_PC() );
+	EXPECT_EQ( checked.get_fault(), Chip8::eFault::NONE );
+}
@@ -0,0 +1,176 @@
+/*
+ * debugger_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "chip8.h"
+#include "debugger.h"
+
+class DebuggerTest : public ::testing::Test
+{
+protected:
+	// Counts V0 up and stores it to 0x300 on every pass through the loop
+	std::vector<uint8_t> program = {
+		0xA3, 0x00,		// 0x200 LD I, 0x300
+		0x70, 0x01,		// 0x202 ADD V0, #1
+		0xF0, 0x55,		// 0x204 LD [I], V0
+		0xA3, 0x00,		// 0x206 LD I, 0x300
+		0x12, 0x02,		// 0x208 JP 0x202
+	};
+
+	Chip8 machine;
+	Debugger debugger;
+
+	void SetUp() override
+	{
+		machine.set_program( program.data(), program.size() );
+		machine.set_quirk_type( Chip8::eQuirkType::CHIP8 );
+		machine.attach_debugger( &debugger );
+	}
+
+	void run( unsigned ticks )
+	{
+		for( unsigned tick = 0; tick < ticks; ++tick )
+			machine.clock_tick();
+	}
+};
+
+TEST_F( DebuggerTest, breakpoint_stops_before_instruction )
+{
+	debugger.add_breakpoint( 0x204 );
+
+	run( 10 );
+
+	ASSERT_TRUE( machine.is_halted() );
+	EXPECT_EQ( machine.get_PC(), 0x204 );
+	EXPECT_EQ( machine.get_byte( 0x300 ), 0 );
+	EXPECT_EQ( debugger.last_event()->kind, Debugger::Event::eKind::BREAKPOINT );
+
+	debugger.resume();
+	run( 1 );
+
+	EXPECT_FALSE( machine.is_halted() );
+	EXPECT_EQ( machine.get_byte( 0x300 ), 1 );
+}
+
+TEST_F( DebuggerTest, resume_after_watch_keeps_next_breakpoint )
+{
+	debugger.add_watch( 0x300 );
+	debugger.add_breakpoint( 0x206 );
+
+	run( 10 );
+
+	ASSERT_EQ( debugger.last_event()->kind, Debugger::Event::eKind::WATCH );
+	EXPECT_EQ( machine.get_PC(), 0x206 );
+
+	debugger.resume();
+	run( 1 );
+
+	ASSERT_TRUE( machine.is_halted() );
+	EXPECT_EQ( debugger.last_event()->kind, Debugger::Event::eKind::BREAKPOINT );
+	EXPECT_EQ( machine.get_PC(), 0x206 );
+}
+
+TEST_F( DebuggerTest, resume_after_pause_keeps_breakpoint_at_pc )
+{
+	run( 2 );		// PC at 0x204
+	debugger.add_breakpoint( 0x204 );
+	debugger.pause();
+
+	debugger.resume();
+	run( 1 );
+
+	ASSERT_TRUE( machine.is_halted() );
+	EXPECT_EQ( debugger.last_event()->kind, Debugger::Event::eKind::BREAKPOINT );
+	EXPECT_EQ( machine.get_byte( 0x300 ), 0 );
+}
+
+TEST_F( DebuggerTest, conditional_breakpoint )
+{
+	debugger.add_breakpoint( 0x204, Condition::compile( "V0 == 3" ) );
+
+	run( 50 );
+
+	ASSERT_TRUE( machine.is_halted() );
+	EXPECT_EQ( machine.get_register( 0 ), 3 );
+}
+
+TEST_F( DebuggerTest, watch_reports_store )
+{
+	debugger.add_watch( 0x300, 1, Condition::compile( "[0x300] >= 2" ) );
+
+	run( 50 );
+
+	ASSERT_TRUE( machine.is_halted() );
+	EXPECT_EQ( debugger.last_event()->kind, Debugger::Event::eKind::WATCH );
+	EXPECT_EQ( debugger.last_event()->pc, 0x204 );
+	EXPECT_EQ( debugger.last_event()->address, 0x300 );
+	EXPECT_EQ( machine.get_byte( 0x300 ), 2 );
+}
+
+TEST_F( DebuggerTest, unwatched_page_does_not_trigger )
+{
+	debugger.add_watch( 0x400 );
+
+	run( 50 );
+
+	EXPECT_FALSE( machine.is_halted() );
+}
+
+TEST_F( DebuggerTest, watch_above_4k )
+{
+	const std::vector<uint8_t> wide = {
+		0xAF, 0xFF,		// 0x200 LD I, 0xFFF
+		0x61, 0x01,		// 0x202 LD V1, #1
+		0xF1, 0x1E,		// 0x204 ADD I, V1
+		0xF0, 0x55,		// 0x206 LD [I], V0
+		0x12, 0x08,		// 0x208 JP 0x208
+	};
+
+	machine.set_program( wide.data(), wide.size() );
+	machine.set_quirk_type( Chip8::eQuirkType::XOCHIP );
+	debugger.add_watch( 0x1000 );
+
+	run( 10 );
+
+	ASSERT_TRUE( machine.is_halted() );
+	EXPECT_EQ( debugger.last_event()->address, 0x1000 );
+	EXPECT_EQ( debugger.last_event()->pc, 0x206 );
+}
+
+TEST_F( DebuggerTest, condition_expressions )
+{
+	machine.clock_tick();	// I = 0x300
+
+	EXPECT_TRUE( Condition::compile( "I == 0x300 && PC > 0x200" ).evaluate( machine ) );
+	EXPECT_TRUE( Condition::compile( "!(V0 != 0) || VF" ).evaluate( machine ) );
+	EXPECT_TRUE( Condition::compile( "(I & 0xF00) - 0x100 == 0x200" ).evaluate( machine ) );
+	EXPECT_FALSE( Condition::compile( "[I + 1] + 1 < 1" ).evaluate( machine ) );
+
+	EXPECT_TRUE( Condition::compile( "08 + 09 == 17 && 0x10 == 16 && 010 == 10" ).evaluate( machine ) );
+
+	EXPECT_THROW( Condition::compile( "V0 ==" ), std::runtime_error );
+	EXPECT_THROW( Condition::compile( "V0 == 0x" ), std::runtime_error );
+	EXPECT_THROW( Condition::compile( "V0 == 65536" ), std::runtime_error );
+	EXPECT_THROW( Condition::compile( "VX == 1" ), std::runtime_error );
+	EXPECT_THROW( Condition::compile( "(V0" ), std::runtime_error );
+}
@@ -0,0 +1,140 @@
+/*
+ * emulation_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "chip8.h"
+#include "debugger.h"
+#include "emulation.h"
+
+using eKind = StepEvent::eKind;
+
+class EmulationTest : public ::testing::Test
+{
+protected:
+	std::vector<uint8_t> program = {
+		0xA3, 0x00,		// 0x200 LD I, 0x300
+		0x70, 0x01,		// 0x202 ADD V0, #1
+		0xF0, 0x55,		// 0x204 LD [I], V0
+		0xC1, 0xFF,		// 0x206 RND V1, #FF
+		0x12, 0x02,		// 0x208 JP 0x202
+	};
+
+	void load( Chip8& machine )
+	{
+		machine.set_program( program.data(), program.size() );
+		machine.set_seed( 7 );
+		machine.set_quirk_type( Chip8::eQuirkType::CHIP8 );
+	}
+};
+
+TEST_F( EmulationTest, frames_match_run_frame )
+{
+	Chip8 stepped;
+	Chip8 reference;
+	load( stepped );
+	load( reference );
+
+	Emulation run = emulate( stepped, 10, 5 );
+
+	for( uint32_t frame = 0; frame < 5; ++frame ) {
+		ASSERT_TRUE( run.next() );
+		EXPECT_EQ( run.event().kind, eKind::FRAME );
+		EXPECT_EQ( run.event().frame, frame );
+
+		reference.run_frame( 10 );
+		EXPECT_EQ( stepped.get_state_hash(), reference.get_state_hash() );
+	}
+
+	EXPECT_FALSE( run.next() );
+}
+
+TEST_F( EmulationTest, key_wait_is_reported )
+{
+	program = {
+		0xF2, 0x0A,		// 0x200 LD V2, K
+		0x12, 0x02,		// 0x202 JP 0x202
+	};
+
+	Chip8 machine;
+	load( machine );
+
+	Emulation run = emulate( machine, 10 );
+
+	ASSERT_TRUE( run.next() );
+	EXPECT_EQ( run.event().kind, eKind::KEY_WAIT );
+
+	machine.set_keys_state( 0x0010 );
+	ASSERT_TRUE( run.next() );
+	machine.set_keys_state( 0 );
+	ASSERT_TRUE( run.next() );
+
+	EXPECT_EQ( run.event().kind, eKind::FRAME );
+	EXPECT_EQ( machine.get_register( 2 ), 4 );
+}
+
+TEST_F( EmulationTest, breakpoint_yields_and_holds_the_instruction )
+{
+	Chip8 machine;
+	Chip8 reference;
+	Debugger debugger;
+	load( machine );
+	load( reference );
+
+	machine.attach_debugger( &debugger );
+	debugger.add_breakpoint( 0x204 );
+
+	Emulation run = emulate( machine, 10, 3 );
+	unsigned breaks = 0;
+
+	while( run.next() ) {
+		if( run.event().kind != eKind::BREAKPOINT )
+			continue;
+
+		EXPECT_EQ( run.event().pc, 0x204 );
+		++breaks;
+		debugger.resume();
+	}
+
+	for( int frame = 0; frame < 3; ++frame )
+		reference.run_frame( 10 );
+
+	EXPECT_GT( breaks, 3u );
+	EXPECT_EQ( machine.get_state_hash(), reference.get_state_hash() );
+}
+
+TEST_F( EmulationTest, many_machines_interleave_on_one_thread )
+{
+	std::vector<Chip8> machines( 16 );
+	std::vector<Emulation> runs;
+
+	for( Chip8& machine : machines ) {
+		load( machine );
+		runs.push_back( emulate( machine, 10, 4 ) );
+	}
+
+	for( int frame = 0; frame < 4; ++frame )
+		for( Emulation& run : runs )
+			ASSERT_TRUE( run.next() );
+
+	for( Chip8& machine : machines )
+		EXPECT_EQ( machine.get_state_hash(), machines[0].get_state_hash() );
+}
@@ -0,0 +1,148 @@
+/*
+ * hash_log_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chip8.h"
+#include "hash_log.h"
+
+class StateHashTest : public ::testing::Test
+{
+protected:
+	// Draws random bytes as sprites and counts V2 down; exercises most write paths
+	std::vector<uint8_t> program = {
+		0x62, 0x20,		// 0x200 LD V2, #32
+		0xC0, 0xFF,		// 0x202 RND V0, #255
+		0xC1, 0x1F,		// 0x204 RND V1, #31
+		0xF0, 0x29,		// 0x206 LD F, V0
+		0xD0, 0x15,		// 0x208 DRW V0, V1, 5
+		0xF2, 0x15,		// 0x20A LD DT, V2
+		0x72, 0xFF,		// 0x20C ADD V2, #255
+		0x12, 0x02,		// 0x20E JP 0x202
+	};
+
+	uint64_t full_hash_of_run( uint32_t seed, unsigned frames, std::ostream * log = nullptr )
+	{
+		Chip8 machine;
+		machine.set_seed( seed );
+		machine.set_program( program.data(), program.size() );
+		machine.set_quirk_type( Chip8::eQuirkType::SCHIP );
+
+		std::optional<HashLogWriter> writer;
+		if( log )
+			writer.emplace( *log );
+
+		for( unsigned frame = 0; frame < frames; ++frame ) {
+			machine.run_frame( 10 );
+			if( writer )
+				writer->record( machine.get_state_hash() );
+		}
+
+		return machine.get_state_hash();
+	}
+};
+
+TEST_F( StateHashTest, same_seed_same_hash )
+{
+	EXPECT_EQ( full_hash_of_run( 7, 20 ), full_hash_of_run( 7, 20 ) );
+	EXPECT_NE( full_hash_of_run( 7, 20 ), full_hash_of_run( 8, 20 ) );
+}
+
+// What chemul8 --hash-log does: seed an unseeded machine, then a fixed number of instructions per frame
+TEST_F( StateHashTest, logged_runs_of_one_rom_are_identical )
+{
+	auto logged_run = [this]() {
+		std::stringstream log;
+		HashLogWriter writer( log );
+		Chip8 machine;
+
+		machine.set_seed( 1 );
+		machine.set_program( program.data(), program.size() );
+		machine.set_quirk_type( Chip8::eQuirkType::CHIP8 );
+
+		for( unsigned frame = 0; frame < 120; ++frame ) {
+			machine.set_keys_state( frame & 0x10 ? 0x0020 : 0x0000 );
+			machine.run_frame( 10 );
+			writer.record( machine.get_state_hash() );
+		}
+
+		return log.str();
+	};
+
+	const std::string first = logged_run();
+	const std::string second = logged_run();
+
+	std::stringstream expected( first );
+	std::stringstream actual( second );
+	EXPECT_FALSE( find_first_divergence( expected, actual ).has_value() );
+	EXPECT_EQ( first, second );
+}
+
+TEST_F( StateHashTest, incremental_hash_matches_reload )
+{
+	Chip8 first;
+	Chip8 second;
+
+	first.set_seed( 1 );
+	second.set_seed( 1 );
+	first.set_program( program.data(), program.size() );
+	second.set_program( program.data(), program.size() );
+	EXPECT_EQ( first.get_state_hash(), second.get_state_hash() );
+
+	first.set_keys_state( 0x0001 );
+	EXPECT_NE( first.get_state_hash(), second.get_state_hash() );
+
+	first.set_keys_state( 0x0000 );
+	EXPECT_EQ( first.get_state_hash(), second.get_state_hash() );
+}
+
+TEST_F( StateHashTest, diff_pinpoints_first_divergent_frame )
+{
+	std::stringstream same_a;
+	std::stringstream same_b;
+	full_hash_of_run( 3, 30, &same_a );
+	full_hash_of_run( 3, 30, &same_b );
+
+	EXPECT_FALSE( find_first_divergence( same_a, same_b ).has_value() );
+
+	std::stringstream expected( "0 0000000000000001\n1 0000000000000002\n2 0000000000000003\n" );
+	std::stringstream actual( "0 0000000000000001\n1 00000000000000ff\n2 0000000000000003\n" );
+
+	auto divergence = find_first_divergence( expected, actual );
+	ASSERT_TRUE( divergence.has_value() );
+	EXPECT_EQ( divergence->frame, 1 );
+	EXPECT_EQ( divergence->expected, 2 );
+	EXPECT_EQ( divergence->actual, 0xFF );
+}
+
+TEST_F( StateHashTest, diff_reports_truncated_log )
+{
+	std::stringstream expected( "0 0000000000000001\n1 0000000000000002\n" );
+	std::stringstream actual( "0 0000000000000001\n" );
+
+	auto divergence = find_first_divergence( expected, actual );
+	ASSERT_TRUE( divergence.has_value() );
+	EXPECT_EQ( divergence->frame, 1 );
+	EXPECT_FALSE( divergence->actual.has_value() );
+}
@@ -0,0 +1,106 @@
+/*
+ * input_latch_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "chip8.h"
+#include "input_latch.h"
+
+TEST( InputLatchTest, AppliesEventsUpToNow )
+{
+	InputLatch input;
+
+	input.post( { 100, 0x1, true } );
+	input.post( { 200, 0x2, true } );
+
+	EXPECT_EQ( input.latch( 150 ), 0x0002 );
+	EXPECT_EQ( input.latch( 250 ), 0x0006 );
+}
+
+TEST( InputLatchTest, SplitsTapAcrossFrames )
+{
+	InputLatch input;
+
+	input.post( { 10, 0x5, true } );
+	input.post( { 20, 0x5, false } );
+	input.post( { 30, 0x7, true } );
+
+	EXPECT_EQ( input.latch( 100 ), 0x0020 );
+	EXPECT_EQ( input.latch( 100 ), 0x0080 );
+}
+
+TEST( InputLatchTest, IgnoresRepeats )
+{
+	InputLatch input;
+
+	input.post( { 10, 0x3, true } );
+	input.post( { 20, 0x3, true } );
+	input.post( { 30, 0x4, true } );
+
+	EXPECT_EQ( input.latch( 100 ), 0x0018 );
+}
+
+TEST( InputLatchTest, WaitForKeySeesTapWithinOneFrame )
+{
+	const uint8_t program[] = {
+		0xF3, 0x0A,		// 0x200 LD V3, K
+		0x12, 0x02,		// 0x202 JP 0x202
+	};
+
+	Chip8 device;
+	device.set_program( program, sizeof( program ) );
+
+	InputLatch input;
+	input.post( { 1, 0x9, true } );
+	input.post( { 2, 0x9, false } );
+
+	for( int frame = 0; frame < 3 && device.get_PC() == 0x200; ++frame ) {
+		device.set_keys_state( input.latch( 10 ) );
+		device.run_frame( 4 );
+	}
+
+	EXPECT_EQ( device.get_PC(), 0x202 );
+	EXPECT_EQ( device.get_register( 3 ), 0x9 );
+}
+
+TEST( InputLatchTest, CrossesThreads )
+{
+	InputLatch input;
+	std::atomic<bool> done { false };
+
+	// 625 runs of 16 transitions, alternating presses and releases; the last run presses every key
+	std::thread producer( [&]() {
+		for( uint64_t n = 0; n < 10000; ++n )
+			while( !input.post( { n, uint8_t( n % 16 ), ( n / 16 ) % 2 == 0 } ) )
+				std::this_thread::yield();
+		done = true;
+	} );
+
+	while( !done )
+		input.latch( 10000 );
+	producer.join();
+
+	for( int frame = 0; frame < 1000; ++frame )
+		input.latch( 10000 );
+
+	EXPECT_EQ( input.get_keys(), 0xFFFF );
+}
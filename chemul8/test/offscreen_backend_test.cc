@@ -0,0 +1,59 @@
+/*
+ * offscreen_backend_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include "chip8.h"
+#include "input_latch.h"
+#include "offscreen_backend.h"
+
+TEST( OffscreenBackendTest, keeps_the_presented_display )
+{
+	const uint8_t program[] = {
+		0xF0, 0x29,		// 0x200 LD F, V0
+		0xD0, 0x05,		// 0x202 DRW V0, V0, 5
+	};
+
+	Chip8 machine;
+	machine.set_program( program, sizeof( program ) );
+	machine.clock_tick();
+	machine.clock_tick();
+
+	OffscreenBackend backend;
+	backend.draw_buffer( machine.get_display_buffer(), machine.get_display_size() );
+
+	EXPECT_EQ( backend.get_frames_drawn(), 1u );
+	EXPECT_EQ( backend.get_display()[0], 0x0F );
+	EXPECT_EQ( backend.get_display()[8], 0x09 );
+}
+
+TEST( OffscreenBackendTest, starts_with_a_restart_and_then_stays_quiet )
+{
+	OffscreenBackend backend;
+	InputLatch input;
+
+	EXPECT_TRUE( backend.should_restart() );
+
+	const uint64_t before = backend.get_ticks();
+	backend.check_events( input );
+
+	EXPECT_FALSE( backend.should_restart() );
+	EXPECT_FALSE( backend.should_quit() );
+	EXPECT_GT( backend.get_ticks(), before );
+}
@@ -0,0 +1,141 @@
+/*
+ * paged_memory_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "chip8.h"
+#include "paged_memory.h"
+
+TEST( PagedMemoryTest, untouched_pages_read_as_zero )
+{
+	PagedMemory memory;
+
+	EXPECT_EQ( memory.get( 0x8123 ), 0 );
+	EXPECT_EQ( memory.present_pages(), 0 );
+
+	memory.at( 0x8123 ) = 0x5A;
+
+	EXPECT_EQ( memory.get( 0x8123 ), 0x5A );
+	EXPECT_EQ( memory.present_pages(), 1 << 8 );
+}
+
+TEST( PagedMemoryTest, write_spans_pages )
+{
+	PagedMemory memory;
+	const std::vector<uint8_t> data( 0x1800, 0xA5 );
+
+	memory.write( 0x0F00, data.data(), data.size() );
+
+	EXPECT_EQ( memory.present_pages(), 0x0007 );
+	EXPECT_EQ( memory.get( 0x0EFF ), 0 );
+	EXPECT_EQ( memory.get( 0x0F00 ), 0xA5 );
+	EXPECT_EQ( memory.get( 0x26FF ), 0xA5 );
+	EXPECT_EQ( memory.get( 0x2700 ), 0 );
+}
+
+TEST( PagedMemoryTest, cleared_page_is_zeroed_when_written_again )
+{
+	PagedMemory memory;
+
+	memory.at( 0x1000 ) = 1;
+	memory.at( 0x1001 ) = 2;
+	memory.clear();
+
+	EXPECT_EQ( memory.get( 0x1001 ), 0 );
+
+	memory.at( 0x1000 ) = 3;
+	EXPECT_EQ( memory.get( 0x1000 ), 3 );
+	EXPECT_EQ( memory.get( 0x1001 ), 0 );
+}
+
+TEST( PagedMemoryTest, copy_holds_only_present_pages )
+{
+	PagedMemory memory;
+	PagedMemory copy;
+
+	copy.at( 0x3000 ) = 7;
+
+	memory.at( 0x2000 ) = 9;
+	copy = memory;
+
+	EXPECT_EQ( copy.present_pages(), 1 << 2 );
+	EXPECT_EQ( copy.get( 0x2000 ), 9 );
+	EXPECT_EQ( copy.get( 0x3000 ), 0 );
+
+	memory.at( 0x2000 ) = 10;
+	EXPECT_EQ( copy.get( 0x2000 ), 9 );
+}
+
+// ADD I, V0 carries I past 4 KB to 0x1010 before V0 and V1 are stored there
+static const std::vector<uint8_t> wide_store = {
+	0xAF, 0xFF,		// 0x200 LD I, #FFF
+	0x60, 0x11,		// 0x202 LD V0, #11
+	0xF0, 0x1E,		// 0x204 ADD I, V0
+	0x61, 0x5A,		// 0x206 LD V1, #5A
+	0xF1, 0x55,		// 0x208 LD [I], V1
+};
+
+TEST( WideAddressTest, xochip_stores_above_4k )
+{
+	Chip8 machine;
+	machine.set_program( wide_store.data(), wide_store.size() );
+	machine.set_quirk_type( Chip8::eQuirkType::XOCHIP );
+
+	Chip8::Snapshot before;
+	machine.save_state( before );
+
+	for( int step = 0; step < 5; ++step )
+		machine.clock_tick();
+
+	EXPECT_EQ( machine.get_byte( 0x1010 ), 0x11 );
+	EXPECT_EQ( machine.get_byte( 0x1011 ), 0x5A );
+
+	const uint64_t after_hash = machine.get_state_hash();
+	EXPECT_NE( after_hash, before.state_hash );
+
+	machine.restore_state( before );
+	EXPECT_EQ( machine.get_byte( 0x1011 ), 0 );
+	EXPECT_EQ( machine.get_state_hash(), before.state_hash );
+}
+
+TEST( WideAddressTest, chip8_wraps_at_4k )
+{
+	Chip8 machine;
+	machine.set_program( wide_store.data(), wide_store.size() );
+	machine.set_quirk_type( Chip8::eQuirkType::SCHIP );
+
+	for( int step = 0; step < 5; ++step )
+		machine.clock_tick();
+
+	EXPECT_EQ( machine.get_byte( 0x1010 ), 0 );
+	EXPECT_EQ( machine.get_byte( 0x0011 ), 0x5A );	// wrapped onto the low byte of I
+}
+
+TEST( WideAddressTest, large_program_is_loaded_whole )
+{
+	std::vector<uint8_t> program( 0x3000, 0 );
+	program.back() = 0x77;
+
+	Chip8 machine;
+	machine.set_program( program.data(), program.size() );
+
+	EXPECT_EQ( machine.get_byte( 0x200 + 0x2FFF ), 0x77 );
+}
@@ -0,0 +1,99 @@
+/*
+ * perf_counters_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "input_latch.h"
+#include "perf_counters.h"
+
+TEST( PerfCountersTest, frames_land_in_millisecond_buckets )
+{
+	PerfCounters counters;
+
+	counters.add_frame( 16600000, 1000, 2 );
+	counters.add_frame( 16900000, 1000, 4 );
+	counters.add_frame( 250000000, 1000, 0 );
+
+	const PerfCounters::Totals totals = counters.read();
+
+	EXPECT_EQ( totals.frames, 3u );
+	EXPECT_EQ( totals.instructions, 3000u );
+	EXPECT_EQ( totals.draws, 6u );
+	EXPECT_EQ( totals.frame_histogram[16], 2u );
+	EXPECT_EQ( totals.frame_histogram[PerfCounters::histogram_buckets - 1], 1u );
+}
+
+TEST( PerfCountersTest, rates_cover_only_the_interval )
+{
+	PerfCounters counters;
+
+	counters.add_frame( 20000000, 5000, 1 );
+	const PerfCounters::Totals earlier = counters.read();
+
+	counters.add_frame( 10000000, 7000, 3 );
+	counters.add_input( 2, 4000000 );
+	counters.add_render( 1000000, 0 );
+	counters.add_render( 3000000, 2 );
+
+	const std::vector<std::string> lines = describe_rates( earlier, counters.read() );
+
+	ASSERT_EQ( lines.size(), 6u );
+	EXPECT_EQ( lines[0], "IPS    700000" );
+	EXPECT_EQ( lines[1], "FRAME  10.00 ms" );
+	EXPECT_EQ( lines[2], "DRW    3.0 / frame" );
+	EXPECT_EQ( lines[3], "INPUT  2.00 ms" );
+	EXPECT_EQ( lines[4], "RENDER 2.00 ms" );
+	EXPECT_EQ( lines[5], "DROP   2" );
+}
+
+TEST( PerfCountersTest, report_lists_used_buckets )
+{
+	PerfCounters counters;
+
+	counters.add_frame( 16600000, 10, 0 );
+
+	std::ostringstream os;
+	print_report( os, counters.read() );
+
+	EXPECT_NE( os.str().find( "    16 : 1\n" ), std::string::npos );
+	EXPECT_EQ( os.str().find( "    17 :" ), std::string::npos );
+}
+
+TEST( PerfCountersTest, latch_reports_time_spent_queued )
+{
+	InputLatch input;
+
+	input.post( { 100, 0x1, true } );
+	input.post( { 300, 0x2, true } );
+	input.post( { 400, 0x1, false } );		// second edge of key 1, waits for the next latch
+
+	input.latch( 1000 );
+
+	InputLatch::Latency latency = input.take_latency();
+	EXPECT_EQ( latency.events, 2u );
+	EXPECT_EQ( latency.total_ns, 900u + 700u );
+
+	latency = input.take_latency();
+	EXPECT_EQ( latency.events, 0u );
+
+	input.latch( 2000 );
+	EXPECT_EQ( input.take_latency().total_ns, 1600u );
+}
@@ -0,0 +1,155 @@
+/*
+ * rollback_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "chip8.h"
+#include "rollback.h"
+
+class RollbackTest : public ::testing::Test
+{
+protected:
+	// Player 0 holds key 0 to count V1 up, player 1 holds key C to count V3 up
+	std::vector<uint8_t> program = {
+		0x60, 0x00,		// 0x200 LD V0, #0
+		0x62, 0x0C,		// 0x202 LD V2, #C
+		0xE0, 0xA1,		// 0x204 SKNP V0
+		0x71, 0x01,		// 0x206 ADD V1, #1
+		0xE2, 0xA1,		// 0x208 SKNP V2
+		0x73, 0x01,		// 0x20A ADD V3, #1
+		0xC4, 0xFF,		// 0x20C RND V4, #FF
+		0x12, 0x04,		// 0x20E JP 0x204
+	};
+
+	static constexpr uint32_t frames = 300;
+
+	// Changes every few frames so predictions are regularly wrong
+	static uint16_t keys_of( unsigned player, uint32_t frame )
+	{
+		const bool down = ( ( frame * 7 + player * 13 ) / ( 5 + player ) ) % 3 == 0;
+		return down ? ( player == 0 ? 0x0001 : 0x1000 ) : 0;
+	}
+
+	void load( Chip8& machine )
+	{
+		machine.set_program( program.data(), program.size() );
+		machine.set_seed( 42 );
+		machine.set_quirk_type( Chip8::eQuirkType::CHIP8 );
+	}
+
+	uint64_t reference_hash()
+	{
+		Chip8 machine;
+		load( machine );
+
+		for( uint32_t frame = 0; frame < frames; ++frame ) {
+			machine.set_keys_state( keys_of( 0, frame ) | keys_of( 1, frame ) );
+			machine.run_frame( 10 );
+		}
+		return machine.get_state_hash();
+	}
+};
+
+TEST_F( RollbackTest, PeersConvergeOverLaggyLink )
+{
+	constexpr uint32_t latency = 4;		// frames
+
+	struct Peer {
+		Chip8 machine;
+		RollbackEngine engine { machine, {} };
+		std::deque<std::pair<uint32_t, uint16_t>> in_flight;	// sent by the other peer
+	};
+
+	Peer peers[2];
+	for( Peer& peer : peers )
+		load( peer.machine );
+
+	for( uint32_t tick = 0; tick < frames + latency; ++tick ) {
+		for( unsigned local = 0; local < 2; ++local ) {
+			Peer& peer = peers[local];
+			Peer& other = peers[1 - local];
+
+			while( !peer.in_flight.empty() && peer.in_flight.front().first + latency <= tick ) {
+				ASSERT_TRUE( peer.engine.add_input( 1 - local, peer.in_flight.front().first, peer.in_flight.front().second ) );
+				peer.in_flight.pop_front();
+			}
+
+			if( tick < frames ) {
+				ASSERT_TRUE( peer.engine.add_input( local, tick, keys_of( local, tick ) ) );
+				other.in_flight.push_back( { tick, keys_of( local, tick ) } );
+				ASSERT_TRUE( peer.engine.advance() );
+			}
+		}
+	}
+
+	const uint64_t expected = reference_hash();
+
+	for( Peer& peer : peers ) {
+		peer.engine.settle();
+
+		EXPECT_EQ( peer.engine.get_confirmed_frame(), frames );
+		EXPECT_GT( peer.engine.get_rollbacks(), 0u );
+		EXPECT_EQ( peer.machine.get_state_hash(), expected );
+	}
+}
+
+TEST_F( RollbackTest, RefusesToRunTooFarAhead )
+{
+	Chip8 machine;
+	load( machine );
+	RollbackEngine engine( machine, { 2, 10, 3 } );
+
+	for( uint32_t frame = 0; frame < 3; ++frame ) {
+		ASSERT_TRUE( engine.add_input( 0, frame, 0 ) );
+		ASSERT_TRUE( engine.advance() );
+	}
+
+	EXPECT_FALSE( engine.advance() );
+	EXPECT_FALSE( engine.add_input( 1, 1, 0 ) );	// out of order
+
+	ASSERT_TRUE( engine.add_input( 1, 0, 0 ) );
+	EXPECT_TRUE( engine.advance() );
+}
+
+TEST_F( RollbackTest, RollbackOfFullWindowIsFast )
+{
+	Chip8 machine;
+	load( machine );
+	RollbackEngine engine( machine, { 2, 10, 8 } );
+
+	for( uint32_t frame = 0; frame < 8; ++frame ) {
+		engine.add_input( 0, frame, 0 );
+		engine.advance();
+	}
+
+	// every prediction for player 1 turns out wrong
+	for( uint32_t frame = 0; frame < 8; ++frame )
+		engine.add_input( 1, frame, 0x1000 );
+
+	auto start = std::chrono::steady_clock::now();
+	engine.settle();
+	auto elapsed = std::chrono::steady_clock::now() - start;
+
+	EXPECT_EQ( engine.get_resimulated_frames(), 8u );
+	EXPECT_LT( elapsed, std::chrono::milliseconds( 1 ) );
+}
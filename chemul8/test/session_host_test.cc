@@ -0,0 +1,158 @@
+/*
+ * session_host_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "host_protocol.h"
+#include "session_host.h"
+
+using namespace HostProtocol;
+
+TEST( HostProtocolTest, ReaderReassemblesSplitMessages )
+{
+	std::vector<uint8_t> stream;
+	const uint8_t keys[] = { 0x34, 0x12 };
+	append_message( stream, eMessage::KEYS, keys, sizeof( keys ) );
+	append_message( stream, eMessage::CLOSE, nullptr, 0 );
+
+	MessageReader reader;
+	Message message;
+
+	reader.feed( stream.data(), 4 );
+	EXPECT_FALSE( reader.next( message ) );
+
+	reader.feed( stream.data() + 4, stream.size() - 4 );
+	ASSERT_TRUE( reader.next( message ) );
+	EXPECT_EQ( message.type, eMessage::KEYS );
+	EXPECT_EQ( message.payload, std::vector<uint8_t>( keys, keys + 2 ) );
+
+	ASSERT_TRUE( reader.next( message ) );
+	EXPECT_EQ( message.type, eMessage::CLOSE );
+	EXPECT_TRUE( message.payload.empty() );
+
+	EXPECT_FALSE( reader.next( message ) );
+}
+
+// Plays the part of a remote player on the other end of a socket pair
+class SessionHostTest : public ::testing::Test
+{
+protected:
+	const SessionHost::Clock::time_point start {};
+	const std::chrono::milliseconds period { 16 };
+
+	SessionHost host { { 2, 10, period } };
+	int client = -1;
+
+	void SetUp() override
+	{
+		int fds[2];
+		ASSERT_EQ( ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds ), 0 );
+
+		client = fds[0];
+		host.add_session( fds[1], start );
+	}
+
+	void TearDown() override { ::close( client ); }
+
+	void send( eMessage type, const std::vector<uint8_t>& payload )
+	{
+		std::vector<uint8_t> bytes;
+		append_message( bytes, type, payload.data(), payload.size() );
+		ASSERT_EQ( ::write( client, bytes.data(), bytes.size() ), ssize_t( bytes.size() ) );
+	}
+
+	bool receive( Message& message )
+	{
+		uint8_t buffer[512];
+		ssize_t received;
+
+		while( !reader.next( message ) ) {
+			if( ( received = ::recv( client, buffer, sizeof( buffer ), MSG_DONTWAIT ) ) <= 0 )
+				return false;
+			reader.feed( buffer, received );
+		}
+		return true;
+	}
+
+private:
+	MessageReader reader;
+};
+
+TEST_F( SessionHostTest, SendsOneFramePerPeriod )
+{
+	send( eMessage::LOAD, {
+		0xF0, 0x29,		// 0x200 LD F, V0
+		0xD0, 0x05,		// 0x202 DRW V0, V0, 5
+		0x12, 0x04,		// 0x204 JP 0x204
+	} );
+
+	host.read_input();
+	host.run_due( start );
+	host.run_due( start + period / 2 );			// not due yet
+	host.run_due( start + period );
+
+	Message frame;
+	ASSERT_TRUE( receive( frame ) );
+	EXPECT_EQ( frame.type, eMessage::FRAME );
+	ASSERT_EQ( frame.payload.size(), frame_payload_size );
+	EXPECT_EQ( frame.payload[0], 0 );
+
+	ASSERT_TRUE( receive( frame ) );
+	EXPECT_EQ( frame.payload[0], 1 );
+	EXPECT_EQ( frame.payload[4], 0x0F );	// top row of the "0" glyph, display waits for the second frame
+
+	EXPECT_FALSE( receive( frame ) );
+	EXPECT_EQ( host.next_deadline(), start + 2 * period );
+}
+
+TEST_F( SessionHostTest, KeysReachTheMachine )
+{
+	send( eMessage::LOAD, {
+		0xE5, 0x9E,		// 0x200 SKP V5
+		0x12, 0x00,		// 0x202 JP 0x200
+		0x60, 0x01,		// 0x204 LD V0, 1
+		0xF0, 0x18,		// 0x206 LD ST, V0
+		0x12, 0x08,		// 0x208 JP 0x208
+	} );
+	send( eMessage::KEYS, { 0x01, 0x00 } );		// key 0 down, V5 is 0
+
+	host.read_input();
+	host.run_due( start );
+
+	Message frame;
+	ASSERT_TRUE( receive( frame ) );
+	EXPECT_EQ( frame.payload[260], 1 );
+}
+
+TEST_F( SessionHostTest, ClosedClientsAreDropped )
+{
+	EXPECT_EQ( host.session_count(), 1u );
+
+	send( eMessage::CLOSE, {} );
+	host.read_input();
+
+	EXPECT_EQ( host.session_count(), 0u );
+	EXPECT_EQ( host.next_deadline(), SessionHost::Clock::time_point::max() );
+}
@@ -0,0 +1,78 @@
+/*
+ * triple_buffer_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "triple_buffer.h"
+
+TEST( TripleBufferTest, ReaderGetsNewestValue )
+{
+	TripleBuffer<int> buffer;
+
+	EXPECT_FALSE( buffer.acquire() );
+
+	buffer.back() = 1;
+	buffer.publish();
+	buffer.back() = 2;
+	buffer.publish();
+
+	ASSERT_TRUE( buffer.acquire() );
+	EXPECT_EQ( buffer.front(), 2 );
+
+	EXPECT_FALSE( buffer.acquire() );
+	EXPECT_EQ( buffer.front(), 2 );
+}
+
+TEST( TripleBufferTest, ValuesNeverTearOrGoBackwards )
+{
+	struct Frame { uint64_t serial; uint64_t check; };
+
+	TripleBuffer<Frame> buffer;
+	std::atomic<bool> done { false };
+
+	std::thread writer( [&]() {
+		for( uint64_t serial = 1; serial <= 100000; ++serial ) {
+			buffer.back() = { serial, ~serial };
+			buffer.publish();
+		}
+		done = true;
+	} );
+
+	uint64_t last = 0;
+	while( true ) {
+		const bool finished = done;
+
+		if( !buffer.acquire() ) {
+			if( finished )
+				break;
+			continue;
+		}
+
+		const Frame& frame = buffer.front();
+		ASSERT_EQ( frame.check, ~frame.serial );
+		ASSERT_GT( frame.serial, last );
+		last = frame.serial;
+	}
+	writer.join();
+
+	EXPECT_EQ( last, 100000u );
+}
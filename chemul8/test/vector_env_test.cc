@@ -0,0 +1,86 @@
+/*
+ * vector_env_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "vector_env.h"
+
+class VectorEnvTest : public ::testing::Test
+{
+protected:
+	static constexpr size_t instances = 4;
+
+	// Stores a BCD score of 5 at 0x300, then draws the "0" glyph at (0,0) and spins
+	std::vector<uint8_t> program = {
+		0x60, 0x05,		// LD V0, #5
+		0xA3, 0x00,		// LD I, 0x300
+		0xF0, 0x33,		// LD B, V0
+		0x61, 0x00,		// LD V1, #0
+		0xF1, 0x29,		// LD F, V1
+		0xD1, 0x15,		// DRW V1, V1, 5
+		0x12, 0x0C,		// JP 0x20C
+	};
+
+	VectorEnv env { { .instances = instances, .cycles_per_frame = 10, .threads = 2 } };
+
+	std::vector<uint16_t> actions = std::vector<uint16_t>( instances, 0 );
+	std::vector<uint8_t> observations = std::vector<uint8_t>( instances * VectorEnv::observation_size, 0xFF );
+	std::vector<float> rewards = std::vector<float>( instances, -1.0F );
+
+	void SetUp() override
+	{
+		env.add_reward_watch( { 0x300, RewardWatch::eEncoding::BCD } );
+		env.reset( program.data(), program.size() );
+	}
+};
+
+TEST_F( VectorEnvTest, reward_follows_watched_score )
+{
+	env.step( actions.data(), observations.data(), rewards.data() );
+
+	for( size_t index = 0; index < instances; ++index )
+		EXPECT_FLOAT_EQ( rewards[index], 5.0F );
+
+	env.step( actions.data(), observations.data(), rewards.data() );
+
+	for( size_t index = 0; index < instances; ++index )
+		EXPECT_FLOAT_EQ( rewards[index], 0.0F );
+}
+
+TEST_F( VectorEnvTest, draw_waits_for_next_frame_with_display_wait_quirk )
+{
+	env.step( actions.data(), observations.data(), rewards.data() );
+
+	for( size_t pixel = 0; pixel < VectorEnv::observation_size; ++pixel )
+		ASSERT_EQ( observations[pixel], 0 );
+
+	env.step( actions.data(), observations.data(), rewards.data() );
+
+	for( size_t index = 0; index < instances; ++index ) {
+		const uint8_t * frame = &observations[index * VectorEnv::observation_size];
+
+		EXPECT_EQ( frame[0], 1 );
+		EXPECT_EQ( frame[3], 1 );
+		EXPECT_EQ( frame[4], 0 );
+		EXPECT_EQ( frame[64], 1 );	// second row starts with the left edge of the "0"
+		EXPECT_EQ( frame[65], 0 );
+	}
+}
@@ -17,57 +17,240 @@
  * MA 02110-1301, USA.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "resourcelayer.h"
+#include "gtk_backend.h"
+#include "offscreen_backend.h"
 #include "chip8.h"
 #include "cmdlineparser.h"
+#include "capture.h"
+#include "hash_log.h"
+#include "input_latch.h"
+#include "perf_counters.h"
+#include "triple_buffer.h"
 
-size_t load_program( std::string &program, uint8_t* buffer )
+#include "disassembler/disassembler.h"
+#include "emulator/stack_analysis.h"
+
+size_t load_program( std::string &program, uint8_t* buffer, size_t size )
 {
 	size_t bytes_read = 0;
 	std::ifstream is = std::ifstream( program );
 
-	while( is.good() )
+	while( is.good() && bytes_read < size )
 		buffer[bytes_read++] = is.get();
 
 	return bytes_read;
 }
 
-int run( std::string program )
+/*
+	CALL and RET skip their bounds checks only when the disassembled call graph proves
+	the stack cannot overflow; whatever stands in the way of the proof is reported.
+*/
+bool stack_depth_proven( const uint8_t * program, size_t size )
+{
+	Disassembler disassembler;
+	disassembler.configure( { 0x200 } );
+
+	const StackProof proof = prove_stack_depth( disassembler.build_ir( BinImage( program, program + size ) ).ir );
+
+	for( uint16_t address : proof.recursive_calls )
+		std::cout << "Recursive call at 0x" << std::hex << address << std::dec << ", stack checks stay on\n";
+
+	for( uint16_t address : proof.entry_returns )
+		std::cout << "RET without CALL at 0x" << std::hex << address << std::dec << '\n';
+
+	if( proof.proven && proof.max_depth > Chip8::stack_capacity )
+		std::cout << "Calls nest " << proof.max_depth << " deep, the stack holds " << Chip8::stack_capacity << '\n';
+
+	return proof.proven && proof.max_depth <= Chip8::stack_capacity;
+}
+
+void print_stats( const Chip8& device )
+{
+	const Chip8::Stats& stats = device.get_stats();
+
+	std::cout << "Instructions executed : " << stats.instructions << '\n';
+	std::cout << "Memory stores         : " << stats.stores << '\n';
+	std::cout << "Stores into code      : " << stats.code_writes << '\n';
+
+	const Chip8::AddressMap& modified = device.get_modified_code();
+
+	for( uint16_t address = 0; address < modified.size(); ++address )
+		if( modified.test( address ) )
+			std::cout << "    self modified code at 0x" << std::hex << address << std::dec << '\n';
+}
+
+struct Frame
+{
+	uint8_t display[256];
+	bool sound;
+	uint64_t number;		// counts up by one per published frame, gaps are frames the UI never showed
+};
+
+// Shared between the UI thread and the CPU thread
+struct CoreLink
+{
+	InputLatch input;
+	TripleBuffer<Frame> frames;
+	PerfCounters counters;
+
+	std::atomic<bool> quit { false };
+	std::atomic<bool> restart { true };
+	std::atomic<int> new_type { -1 };
+};
+
+// What main passes from the command line down to the CPU thread
+struct RunOptions
 {
-	uint8_t buffer[4096];
-	ResourceLayer SDLRef;
-	auto last_time = std::chrono::system_clock::now();
+	bool show_stats = false;
+	std::string hash_log_name;
+	std::string record_name;
+	unsigned scale = 1;
+	uint64_t frame_limit = 0;			// 0 runs until quit
+	std::optional<uint32_t> seed;		// empty keeps the random seed, unless the run is hash logged
+	unsigned cycles_per_frame = 10;		// instructions per frame when frames are stepped
+	bool paced = true;					// false steps frames back to back
+};
+
+/*
+	The CPU thread. Runs the core flat out, as the single threaded loop used to, and
+	publishes the display at the end of every 60Hz frame. It never waits on the UI.
+
+	A hash logged run has to repeat exactly, so it starts from a fixed seed and steps a
+	fixed number of instructions per frame, sleeping out the rest of each 60Hz frame.
+	An unpaced run steps frames the same way but back to back.
+*/
+int run_core( std::string program, CoreLink& link, Backend& backend, const RunOptions& options )
+{
+	std::ofstream hash_log_file;
+	std::optional<HashLogWriter> hash_log;
+
+	if( !options.hash_log_name.empty() ) {
+		hash_log_file.open( options.hash_log_name );
+		hash_log.emplace( hash_log_file );
+	}
+
+	std::unique_ptr<CaptureSink> capture;
+
+	// an encoder failure ends the recording, not the run
+	auto capture_failed = [&capture]( const std::exception& error ) {
+		std::cout << "Recording stopped: " << error.what() << std::endl;
+		capture.reset();
+	};
+
+	if( !options.record_name.empty() ) {
+		try {
+			capture = std::make_unique<CaptureSink>( make_frame_encoder( options.record_name, options.scale ) );
+		}
+		catch( const std::exception& error ) {
+			capture_failed( error );
+		}
+	}
+
+	std::vector<uint8_t> buffer( 0x10000 - 0x200 );		// XO-CHIP programs fill up to 64 KB
+	auto last_time = std::chrono::system_clock::time_point();	// first pass through the loop starts a frame
 	Chip8 device;
-	uint16_t keys_state = 0;
+	Chip8::Stats counted;			// device stats at the previous frame boundary
+	uint64_t frame_number = 0;
+
+	const bool fixed_frames = hash_log.has_value() || !options.paced;
+	const auto frame_period = std::chrono::microseconds( 16667 );
 
-	while( ! SDLRef.should_quit() ) {
+	if( options.seed || fixed_frames )
+		device.set_seed( options.seed.value_or( 1 ) );		// set_program keeps the seed across restarts
 
-		if( SDLRef.should_restart() ) {
+	// Everything done between two frames; false when the program cannot be (re)loaded
+	auto start_frame = [&]() -> bool {
+		// (re)load first, so the frame published and captured below is already the program's
+		if( link.restart.exchange( false ) ) {
 
-			std::memset( buffer, 0, sizeof( buffer ) );
+			std::fill( buffer.begin(), buffer.end(), 0 );
 
-			size_t read = load_program( program, buffer );
+			size_t read = load_program( program, buffer.data(), buffer.size() );
 			if( ! read ) {
 				std::cout << "Cannot read program" << std::endl;
-				return 1;
+				link.quit = true;
+				return false;
 			}
 
-			device.set_program( buffer, read );
+			device.set_program( buffer.data(), read );
+			counted = {};
 			device.set_quirk_type( Chip8::eQuirkType::CHIP8 );
+			device.set_stack_checks( !stack_depth_proven( buffer.data(), read ) );
 		}
 
-		if( SDLRef.set_new_type( ) ) {
-			switch( SDLRef.get_new_type() ) {
-			case 1: device.set_quirk_type( Chip8::eQuirkType::SCHIP ); break;
-			case 2: device.set_quirk_type( Chip8::eQuirkType::XOCHIP ); break;
-			default: device.set_quirk_type( Chip8::eQuirkType::CHIP8 ); break;
+		const auto now = std::chrono::system_clock::now();
+
+		if( last_time != std::chrono::system_clock::time_point() ) {
+			const Chip8::Stats& stats = device.get_stats();
+
+			link.counters.add_frame( std::chrono::duration_cast<std::chrono::nanoseconds>( now - last_time ).count(),
+									 stats.instructions - counted.instructions, stats.draws - counted.draws );
+			counted = stats;
+		}
+		last_time = now;
+
+		Frame& frame = link.frames.back();
+		std::memcpy( frame.display, device.get_display_buffer(), sizeof( frame.display ) );
+		frame.sound = device.get_sound_active();
+		frame.number = ++frame_number;
+		link.frames.publish();
+
+		if( options.frame_limit && frame_number >= options.frame_limit )
+			link.quit = true;
+
+		if( capture ) {
+			try {
+				capture->submit( device.get_display_buffer() );
 			}
+			catch( const std::exception& error ) {
+				capture_failed( error );
+			}
+		}
+
+		switch( link.new_type.exchange( -1 ) ) {
+		case -1: break;
+		case 1: device.set_quirk_type( Chip8::eQuirkType::SCHIP ); break;
+		case 2: device.set_quirk_type( Chip8::eQuirkType::XOCHIP ); break;
+		default: device.set_quirk_type( Chip8::eQuirkType::CHIP8 ); break;
+		}
+
+		// the key state only changes here, at the frame boundary
+		device.set_keys_state( link.input.latch( backend.get_ticks() ) );
+
+		const InputLatch::Latency latency = link.input.take_latency();
+		link.counters.add_input( latency.events, latency.total_ns );
+
+		return true;
+	};
+
+	while( ! link.quit ) {
+
+		if( fixed_frames ) {
+			if( options.paced )
+				std::this_thread::sleep_until( last_time + frame_period );
+
+			if( ! start_frame() )
+				return 1;
+
+			device.run_frame( options.cycles_per_frame );
+			if( hash_log )
+				hash_log->record( device.get_state_hash() );
+			continue;
 		}
 
 		/* this bit is to rate limit the DRW call to 60fps and do proper timing */
@@ -75,24 +258,137 @@ int run( std::string program )
 			( std::chrono::duration<double, std::milli>( std::chrono::system_clock::now() - last_time ).count() > 16 );
 
 		if( interrupt ) {
-			last_time = std::chrono::system_clock::now();
+			if( ! start_frame() )
+				return 1;
+
 			device.decrease_timers();
 		}
 
 		device.set_interrupt( interrupt );
 
-		SDLRef.check_events( keys_state );
-		device.set_keys_state( keys_state );
+		device.clock_tick();
+	}
 
-		if( device.get_sound_active() )
-			SDLRef.make_sound();
+	if( capture ) {
+		try {
+			capture->close();
+		}
+		catch( const std::exception& error ) {
+			capture_failed( error );
+		}
+	}
 
-		SDLRef.draw_buffer( device.get_display_buffer(), device.get_display_size() );
+	if( options.show_stats )
+		print_stats( device );
 
-		device.clock_tick();
+	return 0;
+}
+
+/*
+	The UI thread owns the backend: it polls events into the link and presents the newest
+	published frame, blocking only on vsync. F2 toggles the counters overlay, which is
+	refreshed twice a second of emulated frames.
+*/
+int run( Backend& backend, std::string program, const RunOptions& options )
+{
+	CoreLink link;
+	int result = 0;
+	bool show_overlay = false;
+	PerfCounters::Totals shown;
+	uint64_t presented = 0;
+
+	std::thread core( [&]() { result = run_core( program, link, backend, options ); } );
+
+	while( ! link.quit ) {
+
+		backend.check_events( link.input );
+
+		if( backend.should_quit() )
+			link.quit = true;
+
+		if( backend.should_restart() )
+			link.restart = true;
+
+		if( backend.set_new_type() )
+			link.new_type = backend.get_new_type();
+
+		if( backend.toggle_overlay() ) {
+			show_overlay = !show_overlay;
+			shown = link.counters.read();
+			backend.set_overlay( {} );
+		}
+
+		uint64_t dropped = 0;
+
+		if( link.frames.acquire() ) {
+			const Frame& frame = link.frames.front();
+
+			if( presented && frame.number > presented + 1 )
+				dropped = frame.number - presented - 1;
+			presented = frame.number;
+
+			if( frame.sound )
+				backend.make_sound();
+		}
+
+		backend.draw_buffer( link.frames.front().display, sizeof( Frame::display ) );
+		link.counters.add_render( backend.get_render_time(), dropped );
+
+		if( show_overlay ) {
+			const PerfCounters::Totals totals = link.counters.read();
+
+			if( totals.frame_ns - shown.frame_ns >= 500000000 ) {
+				backend.set_overlay( describe_rates( shown, totals ) );
+				shown = totals;
+			}
+		}
 	}
 
-	return 0;
+	core.join();
+
+	if( options.show_stats )
+		print_report( std::cout, link.counters.read() );
+
+	return result;
+}
+
+/*
+	No window and no UI thread: the core steps frames back to back on the calling thread
+	until the frame limit, for recording or hash logging in batch. The offscreen backend
+	only stands in as the input clock; nothing presses keys.
+*/
+int run_headless( std::string program, RunOptions options )
+{
+	if( ! options.frame_limit ) {
+		std::cout << "--headless needs --frames" << std::endl;
+		return -1;
+	}
+
+	CoreLink link;
+	OffscreenBackend backend;
+
+	options.paced = false;
+
+	const int result = run_core( program, link, backend, options );
+
+	if( options.show_stats )
+		print_report( std::cout, link.counters.read() );
+
+	return result;
+}
+
+std::unique_ptr<Backend> make_backend( const std::string& name )
+{
+	if( name == "sdl" )
+		return std::make_unique<ResourceLayer>();
+
+	if( name == "gtk" )
+		return std::make_unique<GtkBackend>();
+
+	if( name == "offscreen" )
+		return std::make_unique<OffscreenBackend>();
+
+	return nullptr;
 }
 
 int main( int argc, char *argv[] )
@@ -104,5 +400,28 @@ int main( int argc, char *argv[] )
 	if( cmd_line.get_program().empty() )
 		return -1;
 
-	return run( cmd_line.get_program() );
+	RunOptions options;
+	options.show_stats = cmd_line.show_stats();
+	options.hash_log_name = cmd_line.get_hash_log();
+	options.record_name = cmd_line.get_record();
+	options.scale = cmd_line.get_scale();
+	options.frame_limit = cmd_line.get_frames();
+	options.seed = cmd_line.get_seed();
+	options.cycles_per_frame = cmd_line.get_cycles();
+
+	if( cmd_line.headless() )
+		return run_headless( cmd_line.get_program(), options );
+
+	std::unique_ptr<Backend> backend = make_backend( cmd_line.get_backend() );
+
+	if( !backend ) {
+		std::cout << "Unknown backend " << cmd_line.get_backend() << std::endl;
+		return -1;
+	}
+
+	// nobody watches an offscreen run, so its frames are stepped back to back
+	if( cmd_line.get_backend() == "offscreen" )
+		options.paced = false;
+
+	return run( *backend, cmd_line.get_program(), options );
 }
@@ -0,0 +1,67 @@
+/*
+ * chemul8_host.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <atomic>
+#include <csignal>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "session_host.h"
+
+static std::atomic<bool> stop_requested { false };
+
+extern "C" void request_stop( int )
+{
+	stop_requested = true;
+}
+
+static int usage()
+{
+	std::cerr << "usage: chemul8_host socket-path [threads]" << std::endl;
+	return 2;
+}
+
+int main( int argc, char *argv[] )
+{
+	if( argc < 2 || argc > 3 )
+		return usage();
+
+	std::signal( SIGINT, request_stop );
+	std::signal( SIGTERM, request_stop );
+
+	try {
+		SessionHost::Config config;
+		if( argc == 3 )
+			config.threads = std::stoul( argv[2] );
+
+		SessionHost host( config );
+		host.serve( argv[1], stop_requested );
+	} catch( const std::invalid_argument& ) {		// a thread count that is not a number
+		return usage();
+	} catch( const std::out_of_range& ) {
+		return usage();
+	} catch( const std::exception& error ) {
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
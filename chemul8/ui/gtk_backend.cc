@@ -0,0 +1,173 @@
+/*
+ * gtk_backend.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "gtk_backend.h"
+#include "input_latch.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+// -1 for keys that are not on the Chip8 keypad
+static int chip8_key( guint keyval )
+{
+	if( keyval >= GDK_KEY_0 && keyval <= GDK_KEY_9 )
+		return keyval - GDK_KEY_0;
+
+	if( keyval >= GDK_KEY_KP_0 && keyval <= GDK_KEY_KP_9 )
+		return keyval - GDK_KEY_KP_0;
+
+	if( keyval >= GDK_KEY_a && keyval <= GDK_KEY_f )
+		return 0x0A + keyval - GDK_KEY_a;
+
+	if( keyval >= GDK_KEY_A && keyval <= GDK_KEY_F )
+		return 0x0A + keyval - GDK_KEY_A;
+
+	return -1;
+}
+
+// Registering the application runs its startup, which is where GTK gets initialised
+GtkBackend::GtkBackend()
+	: app( Gtk::Application::create( "net.dnatechnologies.chemul8", Gio::Application::Flags::NON_UNIQUE ) )
+{
+	app->register_application();
+
+	canvas.set_content_width( 640 );
+	canvas.set_content_height( 320 );
+	canvas.set_draw_func( sigc::mem_fun( *this, &GtkBackend::on_draw ) );
+
+	auto keys = Gtk::EventControllerKey::create();
+	keys->signal_key_pressed().connect( sigc::mem_fun( *this, &GtkBackend::on_key_pressed ), false );
+	keys->signal_key_released().connect( sigc::mem_fun( *this, &GtkBackend::on_key_released ) );
+	window.add_controller( keys );
+
+	window.signal_close_request().connect( [this]() {
+		pending = Events::QUIT_EVENT;
+		return true;
+	}, false );
+
+	window.set_title( "Chemul8" );
+	window.set_child( canvas );
+	window.set_resizable( false );
+
+	app->add_window( window );
+	window.present();
+
+	pending = Events::RESTART_EVENT;
+}
+
+uint64_t GtkBackend::get_ticks() const
+{
+	return uint64_t( g_get_monotonic_time() ) * 1000;
+}
+
+void GtkBackend::check_events( InputLatch &latch )
+{
+	auto context = Glib::MainContext::get_default();
+
+	input = &latch;
+	while( context->pending() && pending == Events::NO_EVENT )
+		context->iteration( false );
+	input = nullptr;
+
+	last_event = std::exchange( pending, Events::NO_EVENT );
+}
+
+bool GtkBackend::on_key_pressed( guint keyval, guint, Gdk::ModifierType )
+{
+	switch( keyval ) {
+	case GDK_KEY_Escape: pending = Events::QUIT_EVENT; return true;
+	case GDK_KEY_F1: pending = Events::RESTART_EVENT; return true;
+	case GDK_KEY_F2: pending = Events::TOGGLE_OVERLAY_EVENT; return true;
+	case GDK_KEY_F10: new_type = 0; pending = Events::SET_NEW_TYPE_EVENT; return true;		// 0 = CHIP8
+	case GDK_KEY_F11: new_type = 1; pending = Events::SET_NEW_TYPE_EVENT; return true;		// 1 = SCHIP
+	case GDK_KEY_F12: new_type = 2; pending = Events::SET_NEW_TYPE_EVENT; return true;		// 2 = XOCHIP
+	}
+
+	const int key = chip8_key( keyval );
+
+	if( key < 0 || !input )
+		return false;
+
+	input->post( { get_ticks(), uint8_t( key ), true } );	// auto repeat presses are dropped by the latch
+	return true;
+}
+
+void GtkBackend::on_key_released( guint keyval, guint, Gdk::ModifierType )
+{
+	const int key = chip8_key( keyval );
+
+	if( key >= 0 && input )
+		input->post( { get_ticks(), uint8_t( key ), false } );
+}
+
+/*
+	GTK paints on its own frame clock, so this only hands over the pixels and paces the
+	caller to 60 frames per second; the paint happens in the next check_events().
+*/
+void GtkBackend::draw_buffer( const uint8_t *buffer, uint16_t size )
+{
+	std::copy_n( buffer, std::min<size_t>( size, sizeof( display ) ), display );
+	canvas.queue_draw();
+
+	const auto now = std::chrono::steady_clock::now();
+
+	next_present = std::max( next_present + std::chrono::microseconds( 16667 ), now );
+	std::this_thread::sleep_until( next_present );
+}
+
+void GtkBackend::on_draw( const Cairo::RefPtr<Cairo::Context>& cr, int width, int height )
+{
+	const uint64_t start = get_ticks();
+	const double pixel_width = width / 64.0;
+	const double pixel_height = height / 32.0;
+
+	cr->set_source_rgb( 0, 0, 0 );
+	cr->paint();
+
+	cr->set_source_rgb( 1, 1, 1 );
+	for( uint16_t pixel = 0; pixel < sizeof( display ) * 8; ++pixel )
+		if( ( display[pixel / 8] >> ( pixel % 8 ) ) & 0x01 )
+			cr->rectangle( ( pixel % 64 ) * pixel_width, ( pixel / 64 ) * pixel_height, pixel_width, pixel_height );
+	cr->fill();
+
+	cr->set_source_rgb( 1, 0.63, 0 );
+	cr->set_font_size( 10 );
+	for( size_t line = 0; line < overlay.size(); ++line ) {
+		cr->move_to( 4, 12 + 10.0 * line );
+		cr->show_text( overlay[line] );
+	}
+
+	render_time = get_ticks() - start;
+}
+
+/*
+	GTK has no tone generator, only the display bell. make_sound() comes every frame the
+	sound timer runs, so the bell rings at most four times a second while a tone lasts.
+*/
+void GtkBackend::make_sound()
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	if( now < next_bell )
+		return;
+
+	next_bell = now + std::chrono::milliseconds( 250 );
+	window.get_display()->beep();
+}
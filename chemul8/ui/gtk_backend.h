@@ -0,0 +1,59 @@
+/*
+ * gtk_backend.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <gtkmm.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "backend.h"
+
+class InputLatch;
+
+/*
+	The gtkmm 4 backend. There is no Gtk::Application::run(); the emulator keeps its own
+	loop and check_events() drains the GTK main context instead.
+*/
+class GtkBackend : public Backend
+{
+public:
+	GtkBackend();
+
+	void make_sound() override;
+	void draw_buffer( const uint8_t *buffer, uint16_t size ) override;
+	void check_events( InputLatch &input ) override;
+	uint64_t get_ticks() const override;
+
+private:
+	Glib::RefPtr<Gtk::Application> app;
+	Gtk::Window window;
+	Gtk::DrawingArea canvas;
+
+	uint8_t display[256] {};
+	InputLatch * input = nullptr;		// only set while check_events() runs the main context
+	Events pending = Events::NO_EVENT;
+	std::chrono::steady_clock::time_point next_present;
+	std::chrono::steady_clock::time_point next_bell;
+
+	bool on_key_pressed( guint keyval, guint keycode, Gdk::ModifierType state );
+	void on_key_released( guint keyval, guint keycode, Gdk::ModifierType state );
+	void on_draw( const Cairo::RefPtr<Cairo::Context>& cr, int width, int height );
+};
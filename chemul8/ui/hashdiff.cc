@@ -0,0 +1,60 @@
+/*
+ * hashdiff.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "hash_log.h"
+
+int main( int argc, char *argv[] )
+{
+	if( argc != 3 ) {
+		std::cerr << "usage: chemul8_hashdiff expected.log actual.log" << std::endl;
+		return 2;
+	}
+
+	std::ifstream expected( argv[1] );
+	std::ifstream actual( argv[2] );
+
+	if( !expected || !actual ) {
+		std::cerr << "Cannot open hash logs" << std::endl;
+		return 2;
+	}
+
+	auto divergence = find_first_divergence( expected, actual );
+	if( !divergence ) {
+		std::cout << "Logs match" << std::endl;
+		return 0;
+	}
+
+	auto print_hash = []( const char * name, std::optional<uint64_t> hash ) {
+		std::cout << "    " << name << ": ";
+		if( hash )
+			std::cout << std::hex << std::setw( 16 ) << std::setfill( '0' ) << *hash << std::dec << '\n';
+		else
+			std::cout << "<end of log>\n";
+	};
+
+	std::cout << "First divergent frame: " << divergence->frame << '\n';
+	print_hash( "expected", divergence->expected );
+	print_hash( "actual  ", divergence->actual );
+
+	return 1;
+}
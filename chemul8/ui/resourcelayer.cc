@@ -20,20 +20,29 @@
  */
 
 #include "resourcelayer.h"
+#include "input_latch.h"
 
 #include <SDL3/SDL.h>
 
-#include <map>
+#include <array>
 #include <stdexcept>
 
-std::map<SDL_Keycode, uint8_t> mapping = {
-										   { SDLK_0, 0x00 }, { SDLK_1, 0x01 }, { SDLK_2, 0x02 }, { SDLK_3, 0x03 },
-										   { SDLK_4, 0x04 }, { SDLK_5, 0x05 }, { SDLK_6, 0x06 }, { SDLK_7, 0x07 },
-										   { SDLK_8, 0x08 }, { SDLK_9, 0x09 }, { SDLK_A, 0x0A }, { SDLK_B, 0x0B },
-										   { SDLK_C, 0x0C }, { SDLK_D, 0x0D }, { SDLK_E, 0x0E }, { SDLK_F, 0x0F },
-										   { SDLK_KP_0, 0x00 }, { SDLK_KP_1, 0x01 }, { SDLK_KP_2, 0x02 }, { SDLK_KP_3, 0x03 }, { SDLK_KP_4, 0x04 },
-										   { SDLK_KP_5, 0x05 }, { SDLK_KP_6, 0x06 }, { SDLK_KP_7, 0x07 }, { SDLK_KP_8, 0x08 }, { SDLK_KP_9, 0x09 }
-										};
+// Indexed by scancode, so both the main and the keypad digits are a single lookup; -1 is not a Chip8 key
+static const std::array<int8_t, SDL_SCANCODE_COUNT> mapping = []() {
+	std::array<int8_t, SDL_SCANCODE_COUNT> keys;
+	keys.fill( -1 );
+
+	keys[SDL_SCANCODE_0] = 0x00;
+	keys[SDL_SCANCODE_KP_0] = 0x00;
+	for( int digit = 1; digit <= 9; ++digit ) {
+		keys[SDL_SCANCODE_1 + digit - 1] = digit;
+		keys[SDL_SCANCODE_KP_1 + digit - 1] = digit;
+	}
+	for( int letter = 0; letter < 6; ++letter )
+		keys[SDL_SCANCODE_A + letter] = 0x0A + letter;
+
+	return keys;
+}();
 
 /*
 SDL_AudioDeviceID audio_id;
@@ -51,6 +60,8 @@ ResourceLayer::ResourceLayer()
 	if( ! SDL_CreateWindowAndRenderer( "Chemul8", 640, 320, 0, &m_window, &m_renderer ) != 0 )
 		throw std::runtime_error( SDL_GetError() );
 
+	SDL_SetRenderVSync( m_renderer, 1 );		// draw_buffer paces the UI thread
+
 	/*
 		SDL_AudioSpec desired = {
 			.freq = 48000,
@@ -78,36 +89,34 @@ ResourceLayer::~ResourceLayer()
 	SDL_Quit();
 }
 
-void ResourceLayer::check_events( uint16_t &keys )
+uint64_t ResourceLayer::get_ticks() const
+{
+	return SDL_GetTicksNS();
+}
+
+/*
+	Key transitions go into the input queue with their SDL timestamps and are applied
+	when the emulator latches its next frame; only control keys end the poll early.
+*/
+void ResourceLayer::check_events( InputLatch &input )
 {
 	SDL_Event event;
 	Events the_event = Events::NO_EVENT;
 
 	while( SDL_PollEvent( &event ) ) {
-		if( (event.type == SDL_EVENT_KEY_UP) || (event.type == SDL_EVENT_KEY_DOWN))
-			if( switch_event( event, keys, the_event ) )
-				break;
+		if( switch_event( event, input, the_event ) )
+			break;
 	}
 
 	last_event = the_event;
 }
 
-bool ResourceLayer::switch_event( SDL_Event &event, uint16_t &keys, ResourceLayer::Events &the_event )
+bool ResourceLayer::switch_event( SDL_Event &event, InputLatch &input, ResourceLayer::Events &the_event )
 {
 	switch( event.type ) {
 	case SDL_EVENT_KEY_UP:
-		{
-			auto it = mapping.find( event.key.key );
-			if( it == mapping.end() )
-				break;
-
-			uint16_t mask = ( 1 << it->second );
-
-			if( ( keys & mask ) != 0 ) {
-				keys &= ~mask;
-				return true;
-			}
-		}
+		if( mapping[event.key.scancode] >= 0 )
+			input.post( { event.key.timestamp, uint8_t( mapping[event.key.scancode] ), false } );
 		break;
 
 	case SDL_EVENT_KEY_DOWN:
@@ -121,6 +130,11 @@ bool ResourceLayer::switch_event( SDL_Event &event, uint16_t &keys, ResourceLaye
 				return true;
 			}
 
+			if( event.key.key == SDLK_F2 ) {
+				the_event = Events::TOGGLE_OVERLAY_EVENT;
+				return true;
+			}
+
 			if( event.key.key == SDLK_F10 ) {
 				new_type = 0;								// 0 = CHIP8
 				the_event = Events::SET_NEW_TYPE_EVENT;
@@ -139,15 +153,8 @@ bool ResourceLayer::switch_event( SDL_Event &event, uint16_t &keys, ResourceLaye
 				return true;
 			}
 
-			auto it = mapping.find( event.key.key );
-			if( it != mapping.end() ) {
-				uint16_t mask = ( 1 << it->second );
-
-				if( ( keys & mask ) == 0 ) {
-					keys |= mask;
-					return true;
-				}
-			}
+			if( !event.key.repeat && mapping[event.key.scancode] >= 0 )
+				input.post( { event.key.timestamp, uint8_t( mapping[event.key.scancode] ), true } );
 		}
 		break;
 
@@ -171,13 +178,23 @@ void ResourceLayer::draw_pixel( uint8_t x_pos, uint8_t y_pos, bool white )
 	SDL_RenderFillRect( m_renderer, &pixel_loc );
 }
 
-void ResourceLayer::draw_buffer( uint8_t *buffer, uint16_t size )
+void ResourceLayer::draw_buffer( const uint8_t *buffer, uint16_t size )
 {
+	const uint64_t start = SDL_GetTicksNS();
 	uint16_t total_pixels = size * 8;
 
 	for( uint16_t pixel = 0; pixel < total_pixels; ++pixel )
 		draw_pixel( pixel % 64, pixel / 64, ( buffer[pixel / 8] >> ( pixel % 8 ) ) & 0x01 );
 
+	if( !overlay.empty() ) {
+		SDL_SetRenderDrawColor( m_renderer, 255, 160, 0, 255 );
+
+		for( size_t line = 0; line < overlay.size(); ++line )
+			SDL_RenderDebugText( m_renderer, 4, 4 + 10.0F * line, overlay[line].c_str() );
+	}
+
+	render_time = SDL_GetTicksNS() - start;		// present blocks on vsync, so it is left out
+
 	SDL_RenderPresent( m_renderer );
 }
 
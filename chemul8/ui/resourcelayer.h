@@ -21,35 +21,31 @@
 
 #include <cstdint>
 
+#include "backend.h"
+
 struct SDL_Window;
 struct SDL_Renderer;
 union SDL_Event;
 
-class ResourceLayer
+class InputLatch;
+
+// The SDL3 backend: a 640x320 window presenting on vsync
+class ResourceLayer : public Backend
 {
 public:
 
 	ResourceLayer();
 	virtual ~ResourceLayer();
 
-	void make_sound();
-	void draw_buffer( uint8_t *buffer, uint16_t size );
-	void check_events( uint16_t &keys );
-
-	bool should_quit() const { return last_event == Events::QUIT_EVENT; }
-	bool should_restart() const { return last_event == Events::RESTART_EVENT; }
-	bool set_new_type() const { return last_event == Events::SET_NEW_TYPE_EVENT; }
-
-	int get_new_type() const { return new_type; }
+	void make_sound() override;
+	void draw_buffer( const uint8_t *buffer, uint16_t size ) override;
+	void check_events( InputLatch &input ) override;
+	uint64_t get_ticks() const override;
 
 private:
-	enum class Events { NO_EVENT, QUIT_EVENT, RESTART_EVENT, SET_NEW_TYPE_EVENT };
-
 	SDL_Window *m_window;
 	SDL_Renderer *m_renderer;
-	Events last_event = Events::RESTART_EVENT;
-	int new_type;
 
-	bool switch_event( SDL_Event &event, uint16_t &keys, ResourceLayer::Events &the_event );
+	bool switch_event( SDL_Event &event, InputLatch &input, ResourceLayer::Events &the_event );
 	void draw_pixel( uint8_t x_pos, uint8_t y_pos, bool white );
 };
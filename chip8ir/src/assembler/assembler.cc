@@ -66,7 +66,7 @@ uint16_t process_pass2( const ASTDirective& directive, uint16_t address, IRBundl
 		for( size_t i = 0; i < directive.args.size(); ++i )
 			byte_run.emplace_back( evaluate_expression( directive.args[i], symbols ));
 
-		bundle.ir.elements.push_back( DataElement {address, byte_run } );
+		bundle.ir.elements.push_back( DataElement {address, bundle.ir.arena.append( byte_run ) } );
 
 		address += directive.args.size();
 	}
@@ -49,6 +49,7 @@ bool ChasmCmdLineParser::parse_args( int argc, char **argv )
 		("l,listing", "Generate listing file (optional filename)", cxxopts::value<std::string>()->implicit_value("__absent__"))
 		( "h,help", "Show this help message" )
 		( "v,verbose", "Verbose output" )
+		( "O,optimise", "Run the peephole and dead code passes before encoding" )
 		( "o", "Output binary file name", cxxopts::value<std::string>() )
 		( "source", "Source file name", cxxopts::value<std::string>() );
 
@@ -104,6 +105,10 @@ bool ChasmCmdLineParser::is_verbose() const {
     return result["verbose"].as<bool>();
 }
 
+bool ChasmCmdLineParser::is_optimised() const {
+    return result["optimise"].as<bool>();
+}
+
 bool ChasmCmdLineParser::show_help() const {
     return result.count("help") > 0;
 }
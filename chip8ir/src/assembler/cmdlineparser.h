@@ -37,6 +37,7 @@ public:
 	std::string get_binary_name();
 	std::string get_listing_name();
     bool is_verbose() const;
+    bool is_optimised() const;
     bool show_help() const;
 
 private:
@@ -20,127 +20,95 @@
 #include "assembler/dispatcher.h"
 #include "assembler/expression.h"
 
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "ir/opcode_table.h"
+
+/*
+	One entry per mnemonic, built from the opcode table. An entry tries the rows of its
+	mnemonic, those with the most literal tokens first so "LD V1, K" is not read as an
+	immediate, and builds the instruction from the first whose syntax the operands fit.
+*/
+static size_t literal_count( const OpcodeInfo& row )
+{
+	return std::count_if( row.syntax.begin(), row.syntax.end(), []( const char * token ) { return token && !is_operand_token( token ); } );
+}
+
+static bool fits( const OpcodeInfo& row, const ASTInstruction& ast_inst )
+{
+	const size_t count = std::count_if( row.syntax.begin(), row.syntax.end(), []( const char * token ) { return token != nullptr; } );
+
+	if( ast_inst.operands.size() != count )
+		return false;
+
+	for( size_t index = 0; index < count; ++index ) {
+		const std::string_view token = row.syntax[index];
+		const ASTExpression& operand = ast_inst.operands[index];
+
+		if( token == "Vx" || token == "Vy" ) {
+			if( !is_register( operand ) )
+				return false;
+		}
+		else if( is_operand_token( token ) ) {
+			if( is_register( operand ) )
+				return false;
+		}
+		else if( !is_identifier( operand, row.syntax[index] ) )
+			return false;
+	}
+
+	return true;
+}
+
+static Instruction assemble( const OpcodeInfo& row, const ASTInstruction& ast_inst, const ASMSymbolTable& symbols )
+{
+	Reg x { 0 };
+	Reg y { 0 };
+	uint8_t imm = 0;
+	Addr address { 0 };
+
+	for( size_t index = 0; index < ast_inst.operands.size(); ++index ) {
+		const std::string_view token = row.syntax[index];
+		const ASTExpression& operand = ast_inst.operands[index];
+
+		if( token == "Vx" ) x = parse_reg( operand );
+		else if( token == "Vy" ) y = parse_reg( operand );
+		else if( token == "kk" ) imm = parse_imm( operand, symbols ).value;
+		else if( token == "n" ) imm = parse_nibble( operand, symbols ).value;
+		else if( token == "nnn" ) address = parse_addr( operand, symbols );
+	}
+
+	return Instruction::make( row.opcode, x, y, imm, address );
+}
+
 const Dispatcher& get_dispatcher()
 {
-	static const Dispatcher dispatcher =
+	static const Dispatcher dispatcher = []
 	{
-		{ "NOP",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_nop();
-		} },
+		std::unordered_map<std::string, std::vector<const OpcodeInfo *>> forms;
+
+		for( const OpcodeInfo& row : opcode_table )
+			forms[ std::string( row.mnemonic ) ].push_back( &row );
+
+		Dispatcher result;
+
+		for( auto& [mnemonic, rows] : forms ) {
+
+			std::stable_sort( rows.begin(), rows.end(), []( const OpcodeInfo * a, const OpcodeInfo * b ) { return literal_count( *a ) > literal_count( *b ); } );
 
-		{ "CLS",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_clear();
-		} },
+			result.emplace( mnemonic, [mnemonic, rows]( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
+				for( const OpcodeInfo * row : rows )
+					if( fits( *row, ast_inst ) )
+						return assemble( *row, ast_inst, symbols );
 
-		{ "RET",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_return();
-		} },
-
-		{ "CALL", []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_call( parse_addr( ast_inst.operands[0], symbols ));
-		} },
-
-		{ "OR",   []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_or( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ));
-		} },
-
-		{ "AND",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_and( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ));
-		} },
-
-		{ "XOR",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_xor( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ));
-		} },
-
-		{ "SUB",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_sub( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ));
-		} },
-
-		{ "SHR",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_shift_right( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ));
-		} },
-
-		{ "SUBN", []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_subn( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ));
-		} },
-
-		{ "SHL",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_shift_left( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ));
-		} },
-
-		{ "RND",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_rnd( parse_reg( ast_inst.operands[0] ), parse_imm( ast_inst.operands[1], symbols ) );
-		} },
-
-		{ "DRW",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_drw( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ), parse_nibble( ast_inst.operands[2], symbols ));
-		} },
-
-		{ "SKP",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_skip_if_key( parse_reg( ast_inst.operands[0] ) );
-		} },
-
-		{ "SKNP", []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return Instruction::make_skip_not_key( parse_reg( ast_inst.operands[0] ) );
-		} },
-
-		{ "SNE",  []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return ( is_register( ast_inst.operands[1] ) ) ?
-				Instruction::make_skip_neq( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ) ) :
-				Instruction::make_skip_neq( parse_reg( ast_inst.operands[0] ), parse_imm( ast_inst.operands[1], symbols ) );
-		} },
-
-		{ "SE", []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			return ( is_register( ast_inst.operands[1] ) ) ?
-				Instruction::make_skip_eq( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ) ) :
-				Instruction::make_skip_eq( parse_reg( ast_inst.operands[0] ), parse_imm( ast_inst.operands[1], symbols ) );
-		} },
-
-		{ "JP", []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			if( is_register( ast_inst.operands[0] ) ) {
-
-				if( !is_identifier(ast_inst.operands[0], "V0") )
-					throw std::runtime_error("JP indexed must use V0");
-
-				return Instruction::make_jump_indexed( parse_addr( ast_inst.operands[1], symbols ));
-			}
-
-			if( ast_inst.operands.size() != 1 )
-				throw std::runtime_error("Error in JP statement");
-
-			return Instruction::make_jump( parse_addr( ast_inst.operands[0], symbols ));
-		} },
-
-		{ "ADD", []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-			if( is_identifier( ast_inst.operands[0], "I" ) ) return Instruction::make_add_i( parse_reg( ast_inst.operands[1] ) );
-
-			return ( is_register( ast_inst.operands[1] ) ) ?
-				Instruction::make_add( parse_reg( ast_inst.operands[0] ), parse_reg( ast_inst.operands[1] ) ) :
-				Instruction::make_add( parse_reg( ast_inst.operands[0] ), parse_imm( ast_inst.operands[1], symbols ));
-		} },
-		{ "LD", []( const ASTInstruction &ast_inst, const ASMSymbolTable &symbols ) {
-
-			if( is_register( ast_inst.operands[0] ) ) {
-
-				if( is_identifier( ast_inst.operands[1], "K" ) ) return Instruction::make_store_key( parse_reg( ast_inst.operands[0]) );
-				if( is_identifier( ast_inst.operands[1], "DT" ) ) return Instruction::make_store_delay_timer( parse_reg( ast_inst.operands[0]) );
-				if( is_identifier( ast_inst.operands[1], "[I]" ) ) return Instruction::make_load_regs( parse_reg( ast_inst.operands[0]) );
-
-				return( is_register( ast_inst.operands[1] ) ) ?
-					Instruction::make_ld( parse_reg( ast_inst.operands[0]), parse_reg( ast_inst.operands[1]) ) :
-					Instruction::make_ld( parse_reg( ast_inst.operands[0]), parse_imm( ast_inst.operands[1], symbols) );
-			}
+				throw std::runtime_error( "Invalid " + mnemonic + " form" );
+			} );
+		}
 
-			if( is_identifier( ast_inst.operands[0], "DT" ) ) return Instruction::make_load_delay_timer( parse_reg( ast_inst.operands[1]) );
-			if( is_identifier( ast_inst.operands[0], "ST" ) ) return Instruction::make_load_sound_timer( parse_reg( ast_inst.operands[1]) );
-			if( is_identifier( ast_inst.operands[0], "F" ) ) return Instruction::make_sprite_for( parse_reg( ast_inst.operands[1]) );
-			if( is_identifier( ast_inst.operands[0], "B" ) ) return Instruction::make_bcd( parse_reg( ast_inst.operands[1]) );
-			if( is_identifier( ast_inst.operands[0], "[I]" ) ) return Instruction::make_save_regs( parse_reg( ast_inst.operands[1] ) );
-			if( is_identifier( ast_inst.operands[0], "I" ) ) return Instruction::make_ld_i( parse_addr( ast_inst.operands[1], symbols) );
-
-			throw std::runtime_error("Invalid LD form");
-		} },
-	};
+		return result;
+	}();
 
 	return dispatcher;
 }
@@ -45,3 +45,9 @@ std::string ASMSymbolTable::get_label( uint16_t address ) const
 
 	return symbol_map.at( address );
 }
+
+void ASMSymbolTable::for_each_label( const LabelVisitor& visit ) const
+{
+	for( const auto& [address, name] : symbol_map )
+		visit( address, name );
+}
@@ -35,7 +35,8 @@ public:
 	void define_constant( std::string name, uint16_t value );
 
 	uint16_t get_value( std::string name ) const;
-	std::string get_label( uint16_t address ) const;
+	std::string get_label( uint16_t address ) const override;
+	void for_each_label( const LabelVisitor& visit ) const override;
 
 private:
 	std::unordered_map<uint16_t, std::string> symbol_map;
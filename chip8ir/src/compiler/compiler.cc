@@ -24,7 +24,8 @@
 class CompilerSymbols : public ILabelResolver
 {
 public:
-	std::string get_label( uint16_t address ) const { return ""; }
+	std::string get_label( uint16_t ) const override { return ""; }
+	void for_each_label( const LabelVisitor& ) const override {}
 };
 
 
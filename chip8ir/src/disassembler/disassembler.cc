@@ -17,6 +17,7 @@
  * MA 02110-1301, USA.
  */
 
+#include <bitset>
 #include <cassert>
 #include <variant>
 #include <stack>
@@ -25,17 +26,23 @@
 #include "disassembler/symbol_table.h"
 #include "disassembler/disassembler.h"
 #include "ir/decoder.h"
+#include "optimiser/analyses.h"
 
 IRBundle Disassembler::build_ir( const BinImage &binary )
+{
+	return build_ir( std::make_shared<const BinImage>( binary ) );
+}
+
+IRBundle Disassembler::build_ir( std::shared_ptr<const BinImage> binary )
 {
 	IRBundle bundle { {}, std::make_unique<DisasmSymbolTable>() };
 	DisasmMemory memory;
 
 	bundle.ir.origin = configuration.origin;
-	memory.bind( binary, configuration.origin );
+	memory.bind( *binary, configuration.origin );
 
 	collect_instructions( bundle, memory );
-	collect_data_bytes( bundle, memory );
+	collect_data_bytes( bundle, memory, binary );
 	sort_elements( bundle );
 
 	return bundle;
@@ -45,6 +52,7 @@ void Disassembler::collect_instructions( IRBundle& bundle, DisasmMemory& memory
 {
 	std::stack<uint16_t> address_stack;
 	std::unordered_set<uint16_t> decoded_instructions;
+	std::unordered_set<uint16_t> scanned_tables;
 	Decoder decoder;
 
 	DisasmSymbolTable * symbols = dynamic_cast<DisasmSymbolTable *>(bundle.resolver.get() );
@@ -73,8 +81,9 @@ void Disassembler::collect_instructions( IRBundle& bundle, DisasmMemory& memory
 
 			bundle.ir.elements.push_back( InstructionElement { address, result.instruction } );
 
-			for( auto next_address : result.next_addresses )
-				address_stack.push( next_address );
+			if( result.instruction.opcode() != Opcode::JP_V0 )		// collect_table_entries() picks the entries V0 can reach
+				for( auto next_address : result.next_addresses )
+					address_stack.push( next_address );
 
 			switch( result.role ) {
 			case AddressRole::None: break;
@@ -85,32 +94,66 @@ void Disassembler::collect_instructions( IRBundle& bundle, DisasmMemory& memory
 			}
 		}
 
-		for( auto table_address : symbols->get_index_list() ) {
+		symbols->sort_vectors();		// get_label() needs the sorted lists
 
-			while( memory.contains(table_address) && symbols->get_label(table_address).empty() ) {
-
-				address_stack.push( table_address );
-				table_address += 2;
-			}
-		}
+		if( !symbols->get_index_list().empty() )
+			collect_table_entries( bundle, memory, address_stack, decoded_instructions, scanned_tables );
 	}
 
 	symbols->sort_vectors();
 }
 
-void Disassembler::collect_data_bytes( IRBundle& bundle, DisasmMemory& memory )
+/*
+	A JP V0 lands on its base plus V0. Where the value sets of the code found so far pin V0
+	down, only those entries are code. Otherwise the table is walked two bytes at a time from
+	its base up to the next label. New code can widen V0 again, so this runs after every decode round.
+*/
+void Disassembler::collect_table_entries( IRBundle& bundle, DisasmMemory& memory, std::stack<uint16_t>& address_stack,
+										  const std::unordered_set<uint16_t>& decoded_instructions, std::unordered_set<uint16_t>& scanned_tables )
+{
+	const DisasmSymbolTable * symbols = dynamic_cast<DisasmSymbolTable *>(bundle.resolver.get() );
+
+	const BlockGraph graph( bundle.ir );
+	const DataFlow<ValueSetAnalysis> value_sets( graph );
+
+	for( const InstructionElement * element : graph.instructions() ) {
+
+		if( element->instruction.opcode() != Opcode::JP_V0 )
+			continue;
+
+		uint16_t table_address = std::get<Addr>( element->instruction.operands()[0] ).value;
+		const std::bitset<256> v0 = value_sets.before( element->address ).registers[0];
+
+		if( !v0.all() ) {
+			for( unsigned value = 0; value < 256; ++value )
+				if( v0[value] && !decoded_instructions.contains( table_address + value ) )
+					address_stack.push( table_address + value );
+			continue;
+		}
+
+		if( !scanned_tables.insert( table_address ).second )
+			continue;		// every table is walked once, its entries are decoded by now
+
+		do {					// the base carries the table's own label
+			address_stack.push( table_address );
+			table_address += 2;
+		} while( memory.contains(table_address) && symbols->get_label(table_address).empty() );
+	}
+}
+
+void Disassembler::collect_data_bytes( IRBundle& bundle, DisasmMemory& memory, const ByteRun::Storage& source )
 {
-    std::vector<uint8_t> datarun;
     uint16_t run_start = 0;
+    uint16_t run_length = 0;
 
     const uint16_t start = memory.start();
     const uint16_t end   = memory.end();
 
 	auto flush = [&]()
 	{
-		if( !datarun.empty() ) {
-			bundle.ir.elements.push_back( DataElement { run_start, datarun } );
-			datarun.clear();
+		if( run_length ) {
+			bundle.ir.elements.push_back( DataElement { run_start, ByteRun( source, run_start - start, run_length ) } );
+			run_length = 0;
 		}
 	};
 
@@ -125,10 +168,10 @@ void Disassembler::collect_data_bytes( IRBundle& bundle, DisasmMemory& memory )
             if( ! bundle.resolver->get_label( addr ).empty() )
 				flush();
 
-            if( datarun.empty() )
+            if( !run_length )
                 run_start = addr;
 
-            datarun.push_back( memory.get_byte(addr) );
+            ++run_length;
 
         } else            // Instruction byte interrupts data run
 			flush();
@@ -19,6 +19,10 @@
 
 #pragma once
 
+#include <memory>
+#include <stack>
+#include <unordered_set>
+
 #include "ir/chip8ir.h"
 #include "ir/chip8formats.h"
 #include "ir/ir_bundle.h"
@@ -32,16 +36,22 @@ public:
 		uint16_t origin;
 	};
 
+	// Bump with every change to what build_ir() produces, so cached IR of an older build is not reused
+	static constexpr uint32_t ir_version = 3;
+
 	Disassembler() = default;
 
 	void configure( Config config ) { configuration = std::move(config); };
 
 	IRBundle build_ir( const BinImage& binary );
+	IRBundle build_ir( std::shared_ptr<const BinImage> binary );	// data elements slice the image, nothing is copied
 
 private:
 	Config configuration;
 
 	void collect_instructions( IRBundle& bundle, DisasmMemory& memory );
-	void collect_data_bytes( IRBundle& bundle, DisasmMemory& memory );
+	void collect_table_entries( IRBundle& bundle, DisasmMemory& memory, std::stack<uint16_t>& address_stack,
+								const std::unordered_set<uint16_t>& decoded_instructions, std::unordered_set<uint16_t>& scanned_tables );
+	void collect_data_bytes( IRBundle& bundle, DisasmMemory& memory, const ByteRun::Storage& source );
 	void sort_elements( IRBundle& bundle );
 };
\ No newline at end of file
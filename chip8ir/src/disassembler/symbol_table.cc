@@ -26,12 +26,13 @@
 void DisasmSymbolTable::add( std::optional<DecodedSymbol> symbol )
 {
 	if( symbol )
-		symbol_lists[symbol->kind].push_back( symbol->address );
+		add( *symbol );
 }
 
 void DisasmSymbolTable::add( DecodedSymbol symbol )
 {
 	symbol_lists[symbol.kind].push_back( symbol.address );
+	sorted = false;
 }
 
 void DisasmSymbolTable::sort_vectors()
@@ -43,12 +44,12 @@ void DisasmSymbolTable::sort_vectors()
 	sorted = true;
 }
 
+static constexpr std::array<const char *,eSymbolKind::COUNT> prefixes{ "DATA", "FUNC", "LABEL", "TABLE" };
+
 std::string DisasmSymbolTable::get_label( uint16_t address ) const
 {
 	assert( sorted );
 
-	static constexpr std::array<const char *,eSymbolKind::COUNT> prefixes{ "DATA", "FUNC", "LABEL", "TABLE" };
-
 	for( size_t kind = 0; kind < eSymbolKind::COUNT; ++ kind ) {
 
 		auto it = std::lower_bound( symbol_lists[kind].begin(), symbol_lists[kind].end(), address );
@@ -58,3 +59,24 @@ std::string DisasmSymbolTable::get_label( uint16_t address ) const
 
 	return {};
 }
+
+void DisasmSymbolTable::for_each_label( const LabelVisitor& visit ) const
+{
+	assert( sorted );
+
+	for( size_t kind = 0; kind < eSymbolKind::COUNT; ++ kind ) {
+
+		const auto& symbol_list = symbol_lists[kind];
+
+		for( size_t index = 0; index < symbol_list.size(); ++index ) {
+
+			const uint16_t address = symbol_list[index];
+
+			// get_label() names an address after the first kind that has it
+			auto named_before = [&]( const auto& earlier ) { return std::binary_search( earlier.begin(), earlier.end(), address ); };
+
+			if( std::none_of( symbol_lists.begin(), symbol_lists.begin() + kind, named_before ) )
+				visit( address, std::string(prefixes[kind]) + std::to_string( index ) );
+		}
+	}
+}
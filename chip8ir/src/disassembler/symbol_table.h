@@ -45,7 +45,8 @@ public:
 
 	void sort_vectors();
 
-	std::string get_label( uint16_t address ) const;
+	std::string get_label( uint16_t address ) const override;
+	void for_each_label( const LabelVisitor& visit ) const override;
 	std::vector<uint16_t> get_index_list( ) { return symbol_lists[INDEXED]; };
 
 private:
@@ -0,0 +1,151 @@
+/*
+ * stack_analysis.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "emulator/stack_analysis.h"
+
+#include <algorithm>
+#include <stack>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+class StackProver
+{
+public:
+	explicit StackProver( const IRProgram& ir );
+
+	StackProof run( uint16_t entry );
+
+private:
+	enum class eState { ACTIVE, DONE };
+
+	std::unordered_map<uint16_t, Instruction> code;
+	std::unordered_map<uint16_t, eState> routines;
+	std::unordered_map<uint16_t, unsigned> depths;		// deepest stack use below a routine entry
+	StackProof proof;
+
+	unsigned routine_depth( uint16_t entry, bool is_entry_point );
+};
+
+StackProver::StackProver( const IRProgram& ir )
+{
+	for( const ASMElement& element : ir.elements )
+		if( const InstructionElement * instruction = std::get_if<InstructionElement>( &element ) )
+			code.emplace( instruction->address, instruction->instruction );
+}
+
+StackProof StackProver::run( uint16_t entry )
+{
+	proof.max_depth = routine_depth( entry, true );
+	proof.proven = proof.recursive_calls.empty() && proof.unresolved_flow.empty() && proof.entry_returns.empty();
+
+	for( auto * list : { &proof.recursive_calls, &proof.unresolved_flow, &proof.entry_returns } )
+		std::sort( list->begin(), list->end() );
+
+	return proof;
+}
+
+/*
+	Walks every instruction reachable inside the routine, without following CALLs into
+	their callee; each CALL adds one to the depth of the routine it calls.
+*/
+unsigned StackProver::routine_depth( uint16_t entry, bool is_entry_point )
+{
+	routines[entry] = eState::ACTIVE;
+
+	std::unordered_set<uint16_t> visited;
+	std::stack<uint16_t> pending;
+	unsigned depth = 0;
+
+	pending.push( entry );
+
+	while( !pending.empty() ) {
+		const uint16_t address = pending.top();
+		pending.pop();
+
+		if( !visited.insert( address ).second )
+			continue;
+
+		auto it = code.find( address );
+		if( it == code.end() ) {
+			proof.unresolved_flow.push_back( address );
+			continue;
+		}
+
+		const Instruction& instruction = it->second;
+		const uint16_t next = address + 2;
+
+		switch( instruction.opcode() ) {
+		case Opcode::RET:
+			if( is_entry_point )
+				proof.entry_returns.push_back( address );
+			break;
+
+		case Opcode::JP:
+			pending.push( std::get<Addr>( instruction.operands()[0] ).value );
+			break;
+
+		case Opcode::JP_V0:
+		case Opcode::NOP:		// 0nnn, which chemul8 runs as SYS: a jump to nnn
+			proof.unresolved_flow.push_back( address );
+			break;
+
+		case Opcode::CALL:
+			{
+				const uint16_t callee = std::get<Addr>( instruction.operands()[0] ).value;
+				auto state = routines.find( callee );
+
+				if( state == routines.end() )
+					depths[callee] = routine_depth( callee, false );
+				else if( state->second == eState::ACTIVE )
+					proof.recursive_calls.push_back( address );
+
+				depth = std::max( depth, 1 + depths[callee] );
+				pending.push( next );
+			}
+			break;
+
+		case Opcode::SE_Imm:
+		case Opcode::SNE_Imm:
+		case Opcode::SE_Reg:
+		case Opcode::SNE_Reg:
+		case Opcode::SKP:
+		case Opcode::SKNP:
+			pending.push( next );
+			pending.push( next + 2 );
+			break;
+
+		default:
+			pending.push( next );
+			break;
+		}
+	}
+
+	routines[entry] = eState::DONE;
+
+	return depth;
+}
+
+}
+
+StackProof prove_stack_depth( const IRProgram& ir )
+{
+	return StackProver( ir ).run( ir.origin );
+}
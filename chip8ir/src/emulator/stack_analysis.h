@@ -0,0 +1,43 @@
+/*
+ * stack_analysis.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ir/chip8ir.h"
+
+/*
+	Upper bound on the number of return addresses a program can have on the stack,
+	taken over the call graph of the disassembled program. The bound only holds when
+	proven is set: no recursion, no JP V0 or SYS, no flow into bytes that were not decoded
+	and no RET reachable from the entry point without a CALL.
+*/
+struct StackProof
+{
+	bool proven = false;
+	unsigned max_depth = 0;
+
+	std::vector<uint16_t> recursive_calls;		// CALL sites closing a cycle in the call graph
+	std::vector<uint16_t> unresolved_flow;		// JP V0 and SYS sites, instructions running into undecoded bytes
+	std::vector<uint16_t> entry_returns;		// RET reachable from the entry point, would underflow
+};
+
+StackProof prove_stack_depth( const IRProgram& ir );
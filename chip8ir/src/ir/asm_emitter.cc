@@ -17,14 +17,116 @@
  * MA 02110-1301, USA.
  */
 
-#include <iomanip>
+#include <array>
+#include <string_view>
+#include <vector>
 
 #include "ir/asm_emitter.h"
+#include "ir/opcode_table.h"
+
+static constexpr char hex_digits[] = "0123456789ABCDEF";
+
+static constexpr std::array<char, 512> hex_pairs = []
+{
+	std::array<char, 512> pairs {};
+
+	for( size_t byte = 0; byte < 256; ++byte ) {
+		pairs[2 * byte]     = hex_digits[byte >> 4];
+		pairs[2 * byte + 1] = hex_digits[byte & 0xF];
+	}
+	return pairs;
+}();
+
+/*
+	Text is formatted straight into the emitter's buffer, which goes to the stream in
+	blocks rather than a field at a time through the stream's formatting.
+*/
+class ASMEmitter::Output
+{
+public:
+	Output( std::ostream& os, std::string& buffer ) : os( os ), buffer( buffer )
+	{
+		buffer.clear();
+		buffer.reserve( block_size + 1024 );
+	}
+
+	void put( char c ) { buffer.push_back( c ); }
+	void put( std::string_view text ) { buffer.append( text ); }
+	void pad( size_t width, size_t used ) { if( used < width ) buffer.append( width - used, ' ' ); }
+
+	void byte( uint8_t value ) { buffer.append( &hex_pairs[2 * value], 2 ); }
+
+	// Upper case hex, zero padded to at least digits
+	void hex( unsigned value, size_t digits )
+	{
+		char text[8];
+		size_t count = 0;
+
+		do {
+			text[count++] = hex_digits[value & 0xF];
+			value >>= 4;
+		} while( value || count < digits );
+
+		while( count )
+			buffer.push_back( text[--count] );
+	}
+
+	void end_line()
+	{
+		buffer.push_back( '\n' );
+		if( buffer.size() >= block_size )
+			flush();
+	}
+
+	void flush()
+	{
+		os.write( buffer.data(), buffer.size() );
+		buffer.clear();
+	}
+
+private:
+	static constexpr size_t block_size = 64 * 1024;
+
+	std::ostream& os;
+	std::string& buffer;
+};
+
+// The resolver's labels, fetched once per emit and found by address
+class ASMEmitter::Labels
+{
+public:
+	explicit Labels( const ILabelResolver& resolver ) : slot( 0x10000, 0 )
+	{
+		resolver.for_each_label( [this]( uint16_t address, std::string_view label ) {
+			spans.emplace_back( text.size(), label.size() );
+			text.append( label );
+			slot[address] = spans.size();
+		} );
+	}
+
+	std::string_view at( uint16_t address ) const
+	{
+		if( !slot[address] )
+			return {};
+
+		const auto [offset, length] = spans[slot[address] - 1];
+		return std::string_view( text ).substr( offset, length );
+	}
+
+private:
+	std::vector<uint32_t> slot;								// 1 + index into spans, 0 without a label
+	std::vector<std::pair<uint32_t, uint32_t>> spans;		// offset and length in text
+	std::string text;
+};
 
 void ASMEmitter::emit( std::ostream& os, const IRBundle& bundle, const BinImage& bin_image, OutputMode mode )
 {
+	Output out( os, buffer );
+	const Labels labels( *bundle.resolver );
+
 	EmitContext ctx = {
-		.os = os,
+		.out = out,
+		.labels = labels,
 		.bundle = bundle,
 		.bin_image = bin_image,
 		.mode = mode
@@ -34,18 +136,19 @@ void ASMEmitter::emit( std::ostream& os, const IRBundle& bundle, const BinImage&
 
 	for( const auto& element : bundle.ir.elements )
         std::visit( [&]( const auto& v ) { emit_element( ctx, v ); }, element );
+
+	out.flush();
 }
 
 void ASMEmitter::emit_header( const EmitContext& ctx, std::string name )
 {
-	ctx.os << "; Disasembly of " << name << "\n";
-	ctx.os << "; Generated by chidisas8\n";
-	ctx.os << ";\n\n";
-	ctx.os << "\t.ORG ";
+	ctx.out.put( "; Disasembly of " );
+	ctx.out.put( name );
+	ctx.out.put( "\n; Generated by chidisas8\n;\n\n\t.ORG " );
 
 	emit_address( ctx, ctx.bundle.ir.origin );
 
-	ctx.os << "\n\n";
+	ctx.out.put( "\n\n" );
 }
 
 void ASMEmitter::emit_element( const EmitContext& ctx, const InstructionElement& element )
@@ -59,17 +162,28 @@ void ASMEmitter::emit_element( const EmitContext& ctx, const InstructionElement&
 
 	emit_label( ctx, element.address );
 
+	const OpcodeInfo& info = opcode_info( instruction.opcode() );
+
 	emit_mnemonic( ctx, instruction.opcode() );
 
-	for( bool first = true; const auto& operand : instruction.operands() )
+	// Operand tokens in the syntax take the instruction's operands in order, the rest is literal
+	size_t operand = 0;
+
+	for( bool first = true; const char * token : info.syntax )
 	{
-		ctx.os << (first ? " " : ", " );
+		if( !token )
+			break;
+
+		ctx.out.put( first ? " " : ", " );
 		first = false;
 
-		emit_operand( ctx, operand );
+		if( is_operand_token( token ) )
+			emit_operand( ctx, instruction.operands()[operand++] );
+		else
+			ctx.out.put( token );
 	}
 
-	ctx.os << "\n";
+	ctx.out.end_line();
 }
 
 void ASMEmitter::emit_element( const EmitContext& ctx, const DataElement& element )
@@ -79,102 +193,87 @@ void ASMEmitter::emit_element( const EmitContext& ctx, const DataElement& elemen
 
 	emit_label( ctx, element.address );
 
-	ctx.os << ".DB";
+	ctx.out.put( ".DB" );
 
 	for( bool first = true; const auto& byte : element.byte_run )
 	{
-		ctx.os << (first ? " " : ", " );
+		ctx.out.put( first ? " 0x" : ", 0x" );
 		first = false;
 
-		ctx.os << std::hex << "0x" << std::setw(2) << std::setfill('0') << std::uppercase << +byte;
+		ctx.out.byte( byte );
 	}
 
-	ctx.os << " ; ";
-	for( const auto& byte : element.byte_run)
-		ctx.os << (byte >= 0x20 && byte <= 0x7E) ? static_cast<char>( byte ) : '.';
+	ctx.out.put( " ; " );
+	for( const auto& byte : element.byte_run )
+		ctx.out.put( (byte >= 0x20 && byte <= 0x7E) ? static_cast<char>( byte ) : '.' );
 
-	ctx.os << "\n";
+	ctx.out.end_line();
 }
 
 void ASMEmitter::emit_address( const EmitContext& ctx, uint16_t address )
 {
-	ctx.os << "0x" << std::hex << std::uppercase << std::setw(3) << std::setfill('0') << address << "  ";
+	ctx.out.put( "0x" );
+	ctx.out.hex( address, 3 );
+	ctx.out.put( "  " );
 }
 
 void ASMEmitter::emit_opcode( const EmitContext& ctx, uint16_t address )
 {
-	uint8_t high_byte = ctx.bin_image[ address - ctx.bundle.ir.origin ];
-	uint8_t low_byte  = ctx.bin_image[ address - ctx.bundle.ir.origin + 1 ];
-
-	ctx.os << std::hex << std::uppercase
-		<< std::setw(2) << std::setfill('0') << +high_byte << " ";
-
-	ctx.os << std::hex << std::uppercase
-		<< std::setw(2) << std::setfill('0') << +low_byte << "  ";
+	ctx.out.byte( ctx.bin_image[ address - ctx.bundle.ir.origin ] );
+	ctx.out.put( ' ' );
+	ctx.out.byte( ctx.bin_image[ address - ctx.bundle.ir.origin + 1 ] );
+	ctx.out.put( "  " );
 }
 
 void ASMEmitter::emit_label( const EmitContext& ctx, uint16_t address )
 {
-	std::string label = ctx.bundle.resolver->get_label( address );
+	const std::string_view label = ctx.labels.at( address );
 
-	if( !label.empty() )
-		label += ":";
+	if( label.empty() ) {
+		ctx.out.pad( 8, 0 );
+		return;
+	}
 
-	ctx.os << std::left << std::setw(8) << std::setfill(' ') << label;
+	ctx.out.put( label );
+	ctx.out.put( ':' );
+	ctx.out.pad( 8, label.size() + 1 );
 }
 
 void ASMEmitter::emit_mnemonic( const EmitContext& ctx, const Opcode& opcode )
 {
-	static std::array<std::string, opcode_count> mnemonics = {
-		"NOP", "CLS", "RET", "JP", "CALL", "SE",
-		"SNE", "SE", "LD", "ADD", "LD", "OR", "AND",
-		"XOR", "ADD", "SUB", "SHR", "SUBN", "SHL", "SNE", "LD I,",
-		"JP V0,", "RND", "DRW", "SKP", "SKNP", "LD DT,",
-		"LD ST,", "ST K,", "ST DT,", "ADD I,",
-		"LD F,", "LD B,", "ST [I],", "LD [I],"
-	};
-
-	ctx.os << mnemonics[ static_cast<int>(opcode) ];
+	ctx.out.put( opcode_info( opcode ).mnemonic );
 }
 
-struct StreamStateGuard
-{
-    StreamStateGuard(std::ostream& os) : os(os), flags(os.flags()), fill(os.fill()) {}
-
-    ~StreamStateGuard() {
-        os.flags(flags);
-        os.fill(fill);
-    }
-
-    std::ostream& os;
-    std::ios::fmtflags flags;
-    char fill;
-};
-
 void ASMEmitter::emit_operand( const EmitContext& ctx, const Operand& op )
 {
     std::visit( [&](auto&& v)
 	{
-		StreamStateGuard guard(ctx.os);
-
         using T = std::decay_t<decltype(v)>;
 
-		if constexpr( std::is_same_v<T, Reg> )
-			ctx.os << "V" << std::uppercase << std::hex << +v.index;
+		if constexpr( std::is_same_v<T, Reg> ) {
+			ctx.out.put( 'V' );
+			ctx.out.hex( v.index, 1 );
+		}
 
 		else if constexpr( std::is_same_v<T, Addr> ) {
-			std::string target = ctx.bundle.resolver->get_label( v.value );
-			if( target.empty() )
-				ctx.os << "0x" << std::uppercase << std::hex << std::setw(3) << std::setfill('0') << +v.value;
+			const std::string_view target = ctx.labels.at( v.value );
+			if( target.empty() ) {
+				ctx.out.put( "0x" );
+				ctx.out.hex( v.value, 3 );
+			}
 			else
-				ctx.os << target;
+				ctx.out.put( target );
 		}
 
-		else if constexpr( std::is_same_v<T, Imm> )
-			ctx.os << "#" << std::dec << +v.value;
+		else if constexpr( std::is_same_v<T, Imm> ) {		// the assembler reads # numbers as hex
+			ctx.out.put( '#' );
+			ctx.out.byte( v.value );
+		}
 
-		else if constexpr( std::is_same_v<T, Nibble> )
-			ctx.os << "0x" << std::uppercase << std::hex << +v.value;
+		else if constexpr( std::is_same_v<T, Nibble> ) {
+			ctx.out.put( "0x" );
+			ctx.out.hex( v.value, 1 );
+		}
 
 	}, op);
 }
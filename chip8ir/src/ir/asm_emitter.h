@@ -41,14 +41,19 @@ public:
 	void configure( Config config ) { configuration = std::move(config); };
 
 private:
+	class Output;
+	class Labels;
+
 	struct EmitContext {
-		std::ostream& os;
+		Output& out;
+		const Labels& labels;
 		const IRBundle& bundle;
 		const BinImage& bin_image;
 		OutputMode mode;
 	};
 
 	Config configuration;
+	std::string buffer;			// kept between emits so its capacity is reused
 
 	void emit_header( const EmitContext& ctx, std::string name );
 	void emit_element( const EmitContext& ctx, const InstructionElement& element );
@@ -18,19 +18,10 @@
   */
 
 #include "ir/cfg_emitter.h"
+#include "ir/opcode_table.h"
 
 #include <map>
 #include <unordered_map>
-#include <array>
-
-static std::array<std::string, opcode_count> mnemonics = {
-	"NOP", "CLS", "RET", "JP", "CALL", "SE",
-	"SNE", "LD", "ADD", "OR", "AND",
-	"XOR", "SUB", "SHR", "SUBN", "SHL", "LD I,",
-	"JP V0,", "RND", "DRW", "SKP", "SKNP", "LD DT,",
-	"LD ST,", "ST K,", "ST DT,", "ADD I,",
-	"LD F,", "LD B,", "ST [I],", "LD [I],"
-};
 
 void CFGEmitter::emit( std::ostream &os, const IRProgram &ir, OutputMode mode )
 {
@@ -62,38 +53,32 @@ CFGEmitter::CFGraph CFGEmitter::build_graph( const IRProgram &ir )
 			CFGNode node;
 
 			node.address = instruction_element->address;
-			node.mnemonic =  mnemonics[ static_cast<int>(instruction_element->instruction.opcode()) ];
+			const OpcodeInfo& info = opcode_info( instruction_element->instruction.opcode() );
+			const uint16_t next = instruction_element->address + 2;
 
-			switch( instruction_element->instruction.opcode() ) {
-			case Opcode::CALL:
-				node.successors.push_back( { static_cast<uint16_t>(instruction_element->address + 2), "" } );
-				// fall through
+			node.mnemonic = info.name;
 
-			case Opcode::JP: {
-				auto target = std::get<Addr>(instruction_element->instruction.operands()[0]).value;
-				node.successors.push_back( { target, "" } );
+			switch( info.successors ) {
+			case Successors::NextAndTarget:
+				node.successors.push_back( { next, "" } );
+				node.successors.push_back( { std::get<Addr>(instruction_element->instruction.operands()[0]).value, "" } );
 				break;
-			}
 
-			case Opcode::RET:
+			case Successors::Target:
+				node.successors.push_back( { std::get<Addr>(instruction_element->instruction.operands()[0]).value, "" } );
 				break;
 
-			case Opcode::SE_Imm:
-			case Opcode::SE_Reg:
-			case Opcode::SKP:
-				node.successors.push_back( { static_cast<uint16_t>(instruction_element->address + 2), "false" } );
-				node.successors.push_back( { static_cast<uint16_t>(instruction_element->address + 4), "true" } );
+			case Successors::None:
 				break;
 
-			case Opcode::SNE_Imm:
-			case Opcode::SNE_Reg:
-			case Opcode::SKNP:
-				node.successors.push_back( { static_cast<uint16_t>(instruction_element->address + 2), "false" } );
+			case Successors::NextOrSkip:
+				node.successors.push_back( { next, "false" } );
 				node.successors.push_back( { static_cast<uint16_t>(instruction_element->address + 4), "true" } );
 				break;
 
-			default:
-				node.successors.push_back( { static_cast<uint16_t>(instruction_element->address + 2), "" } );
+			case Successors::Invalid:
+			case Successors::Next:
+				node.successors.push_back( { next, "" } );
 				break;
 			}
 
@@ -18,12 +18,29 @@
   */
 
 #include "ir/chip8ir.h"
+#include "ir/opcode_table.h"
 
 #include <algorithm>
 #include <cassert>
 #include <variant>
 #include <iomanip>
 
+Instruction Instruction::make( Opcode opcode, Reg x, Reg y, uint8_t imm, Addr address )
+{
+	assert( x.index < 16 && y.index < 16 && address.value < 0x1000 );
+
+	switch( opcode_info( opcode ).layout ) {
+	case OperandLayout::None:     return Instruction( opcode, { } );
+	case OperandLayout::X:        return Instruction( opcode, { x } );
+	case OperandLayout::Address:  return Instruction( opcode, { address } );
+	case OperandLayout::XByte:    return Instruction( opcode, { x, Imm { imm } } );
+	case OperandLayout::XY:       return Instruction( opcode, { x, y } );
+	case OperandLayout::XYNibble: return Instruction( opcode, { x, y, Nibble { uint8_t( imm & 0x0F ) } } );
+	}
+
+	return make_nop();
+}
+
 bool operator==( const IRProgram& a, const IRProgram& b )
 {
 	if( a.origin != b.origin )
@@ -199,16 +216,7 @@ std::ostream& operator<<(std::ostream& os, const Instruction& instr)
 
 std::ostream& operator<<(std::ostream& os, const Opcode& opcode )
 {
-	static std::array<std::string, opcode_count> mnemonics = {
-		"NOP", "CLS", "RET", "JP", "CALL", "SE",
-		"SNE", "SE", "LD", "ADD", "LD", "OR", "AND",
-		"XOR", "ADD", "SUB", "SHR", "SUBN", "SHL", "SNE", "LD I",
-		"JP V0", "RND", "DRW", "SKP", "SKNP", "LD DT",
-		"LD ST", "ST K", "ST DT", "ADD I",
-		"LD F", "LD B", "ST [I]", "LD [I]"
-	};
-
-    os << "Opcode: " << mnemonics[static_cast<int>(opcode)];
+    os << "Opcode: " << opcode_info( opcode ).name;
 
 	return os;
 }
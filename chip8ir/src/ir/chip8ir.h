@@ -28,8 +28,10 @@
 #include <algorithm>
 #include <vector>
 #include <optional>
+#include <memory>
+#include <initializer_list>
 
-enum class Opcode
+enum class Opcode : uint8_t
 {
 	NOP, CLS, RET, JP, CALL, SE_Imm,
 	SNE_Imm, SE_Reg, LD_Imm, ADD_Imm, LD_Reg, OR, AND,
@@ -93,6 +95,9 @@ public:
 	static Instruction make_save_regs( Reg x )                 { assert( x.index < 16 );                 return Instruction( Opcode::ST_REGS,   { x } ); }
 	static Instruction make_load_regs( Reg x )                 { assert( x.index < 16 );                 return Instruction( Opcode::LD_REGS,   { x } ); }
 
+	// Any instruction from its fields; the fields the opcode has no operand for are ignored
+	static Instruction make( Opcode opcode, Reg x, Reg y, uint8_t imm, Addr addr );
+
 
 	Opcode opcode() const { return opcode_; }
 	std::span<const Operand> operands() const { return { operands_.data(), operand_count_ }; }
@@ -111,10 +116,55 @@ private:
 	}
 };
 
+/*
+	The bytes of a DataElement are a slice of storage shared by all the elements cut
+	from it, the source image of a disassembly or the program's arena, so an element
+	never owns a buffer of its own. A slice keeps its storage alive.
+*/
+class ByteRun
+{
+public:
+	using Storage = std::shared_ptr<const std::vector<uint8_t>>;
+
+	ByteRun() = default;
+	ByteRun( Storage storage, size_t offset, size_t length ) : storage( std::move( storage ) ), offset( offset ), length( length ) {}
+	ByteRun( std::vector<uint8_t> bytes ) : ByteRun( std::make_shared<const std::vector<uint8_t>>( std::move( bytes ) ), 0, 0 ) { length = storage->size(); }
+	ByteRun( std::initializer_list<uint8_t> bytes ) : ByteRun( std::vector<uint8_t>( bytes ) ) {}
+
+	size_t size() const { return length; }
+	bool empty() const { return length == 0; }
+
+	const uint8_t * data() const { return storage ? storage->data() + offset : nullptr; }
+	const uint8_t * begin() const { return data(); }
+	const uint8_t * end() const { return data() + length; }
+	uint8_t operator[]( size_t index ) const { return data()[index]; }
+
+private:
+	Storage storage;
+	uint32_t offset = 0;
+	uint32_t length = 0;
+};
+
+// Append-only byte storage for runs that do not come from a source image
+class ByteArena
+{
+public:
+	ByteRun append( std::span<const uint8_t> bytes )
+	{
+		const size_t offset = storage->size();
+
+		storage->insert( storage->end(), bytes.begin(), bytes.end() );
+		return ByteRun( storage, offset, bytes.size() );
+	}
+
+private:
+	std::shared_ptr<std::vector<uint8_t>> storage = std::make_shared<std::vector<uint8_t>>();
+};
+
 struct DataElement
 {
 	uint16_t address;
-	std::vector<uint8_t> byte_run;
+	ByteRun byte_run;
 };
 
 struct InstructionElement
@@ -129,6 +179,7 @@ struct IRProgram
 {
     uint16_t origin = 0x200;
     std::vector<ASMElement> elements;
+    ByteArena arena;			// backs the data elements made by the assembler
 };
 
 bool operator==( const IRProgram& a, const IRProgram& b );
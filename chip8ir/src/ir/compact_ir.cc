@@ -0,0 +1,100 @@
+/*
+ * compact_ir.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "ir/compact_ir.h"
+
+#include <algorithm>
+
+PackedInstruction::PackedInstruction( uint16_t location, const Instruction& instruction )
+	: opcode_( instruction.opcode() ), location_( location )
+{
+	bool have_x = false;
+
+	for( const Operand& operand : instruction.operands() ) {
+		if( auto reg = std::get_if<Reg>( &operand ) ) {
+			registers_ |= have_x ? reg->index : uint8_t( reg->index << 4 );
+			have_x = true;
+		}
+
+		else if( auto addr = std::get_if<Addr>( &operand ) )
+			address_ = addr->value;
+
+		else if( auto imm = std::get_if<Imm>( &operand ) )
+			imm_ = imm->value;
+
+		else if( auto nibble = std::get_if<Nibble>( &operand ) )
+			imm_ = nibble->value;
+	}
+}
+
+const PackedInstruction * CompactProgram::find_instruction( uint16_t location ) const
+{
+	auto it = std::lower_bound( instructions.begin(), instructions.end(), location,
+								[]( const PackedInstruction& instruction, uint16_t value ) { return instruction.location() < value; } );
+
+	return ( it != instructions.end() && it->location() == location ) ? &*it : nullptr;
+}
+
+CompactProgram compact( const IRProgram& ir )
+{
+	CompactProgram program;
+	program.origin = ir.origin;
+
+	for( const ASMElement& element : ir.elements ) {
+		if( auto instruction = std::get_if<InstructionElement>( &element ) )
+			program.instructions.emplace_back( instruction->address, instruction->instruction );
+
+		else if( auto data = std::get_if<DataElement>( &element ) ) {
+			program.data.push_back( { data->address, uint16_t( data->byte_run.size() ), uint32_t( program.data_bytes.size() ) } );
+			program.data_bytes.insert( program.data_bytes.end(), data->byte_run.begin(), data->byte_run.end() );
+		}
+	}
+
+	std::stable_sort( program.instructions.begin(), program.instructions.end(),
+					  []( const PackedInstruction& a, const PackedInstruction& b ) { return a.location() < b.location(); } );
+
+	std::stable_sort( program.data.begin(), program.data.end(),
+					  []( const DataRun& a, const DataRun& b ) { return a.address < b.address; } );
+
+	return program;
+}
+
+IRProgram expand( const CompactProgram& program )
+{
+	IRProgram ir;
+	ir.origin = program.origin;
+	ir.elements.reserve( program.instructions.size() + program.data.size() );
+
+	auto instruction = program.instructions.begin();
+	auto data = program.data.begin();
+
+	while( instruction != program.instructions.end() || data != program.data.end() ) {
+
+		if( data == program.data.end() || ( instruction != program.instructions.end() && instruction->location() <= data->address ) ) {
+			ir.elements.push_back( InstructionElement { instruction->location(), instruction->expand() } );
+			++instruction;
+		} else {
+			const std::span<const uint8_t> bytes = program.bytes( *data );
+			ir.elements.push_back( DataElement { data->address, std::vector<uint8_t>( bytes.begin(), bytes.end() ) } );
+			++data;
+		}
+	}
+
+	return ir;
+}
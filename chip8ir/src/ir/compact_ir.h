@@ -0,0 +1,89 @@
+/*
+ * compact_ir.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ir/chip8ir.h"
+
+/*
+	An instruction in 8 bytes: the opcode, both register nibbles, kk or n, the 12 bit
+	address operand and the instruction's own location. The accessors hand out the same
+	typed operands as Instruction; a field the opcode does not use reads as zero.
+*/
+class PackedInstruction
+{
+public:
+	PackedInstruction() = default;
+	PackedInstruction( uint16_t location, const Instruction& instruction );
+
+	uint16_t location() const { return location_; }
+	Opcode opcode() const { return opcode_; }
+
+	Reg x() const { return Reg { uint8_t( registers_ >> 4 ) }; }
+	Reg y() const { return Reg { uint8_t( registers_ & 0x0F ) }; }
+	Imm byte() const { return Imm { imm_ }; }
+	Nibble nibble() const { return Nibble { uint8_t( imm_ & 0x0F ) }; }
+	Addr target() const { return Addr { address_ }; }
+
+	// What expand() accepts; x and y are nibbles and cannot be out of range
+	bool is_valid() const { return size_t( opcode_ ) < opcode_count && address_ < 0x1000; }
+	Instruction expand() const { return Instruction::make( opcode_, x(), y(), imm_, target() ); }
+
+	friend bool operator==( const PackedInstruction& a, const PackedInstruction& b ) = default;
+
+private:
+	Opcode opcode_ = Opcode::NOP;
+	uint8_t registers_ = 0;		// x in the high nibble, y in the low
+	uint8_t imm_ = 0;
+	uint8_t reserved_ = 0;
+	uint16_t address_ = 0;
+	uint16_t location_ = 0;
+};
+
+static_assert( sizeof( PackedInstruction ) == 8 );
+
+struct DataRun
+{
+	uint16_t address;
+	uint16_t length;
+	uint32_t offset;		// into CompactProgram::data_bytes
+};
+
+/*
+	IRProgram with instructions and data split into their own arrays, each sorted by
+	address, and the data bytes of all runs stored back to back.
+*/
+struct CompactProgram
+{
+	uint16_t origin = 0x200;
+	std::vector<PackedInstruction> instructions;
+	std::vector<DataRun> data;
+	std::vector<uint8_t> data_bytes;
+
+	std::span<const uint8_t> bytes( const DataRun& run ) const { return { data_bytes.data() + run.offset, run.length }; }
+
+	const PackedInstruction * find_instruction( uint16_t location ) const;
+};
+
+CompactProgram compact( const IRProgram& ir );
+IRProgram expand( const CompactProgram& program );		// elements come back in address order
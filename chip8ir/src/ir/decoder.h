@@ -20,19 +20,47 @@
 #pragma once
 
 #include <array>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
 
 #include "ir/chip8ir.h"
+#include "ir/opcode_table.h"
 // #include "ir/symbol_table.h"
 
-using AddressList = std::vector<uint16_t>;
+// An instruction has at most two successors (fall through and skip, or return and call target)
+class AddressList
+{
+public:
+	static constexpr size_t capacity = 2;
+
+	constexpr AddressList() = default;
+	constexpr AddressList( std::initializer_list<uint16_t> list ) { for( uint16_t address : list ) push_back( address ); }
+
+	constexpr void push_back( uint16_t address ) { assert( count < capacity ); addresses[count++] = address; }
+
+	constexpr size_t size() const { return count; }
+	constexpr bool empty() const { return count == 0; }
+	constexpr uint16_t operator[]( size_t index ) const { return addresses[index]; }
+
+	constexpr const uint16_t * begin() const { return addresses.data(); }
+	constexpr const uint16_t * end() const { return addresses.data() + count; }
 
-enum class AddressRole
+private:
+	std::array<uint16_t, capacity> addresses {};
+	uint8_t count = 0;
+};
+
+// One entry per 16 bit opcode, operand fields are only meaningful for the opcodes that use them
+struct DecodeEntry
 {
-    None,
-    JumpTarget,
-    SubroutineTarget,
-    ILoadTarget,
-    IndexedBase
+	Opcode opcode;
+	uint8_t x;
+	uint8_t y;
+	uint8_t imm;			// kk or n
+	uint16_t address;		// nnn
+	Successors successors;
+	AddressRole role;
 };
 
 struct DecodeResult
@@ -46,31 +74,16 @@ struct DecodeResult
 	uint16_t referenced_address = 0;
 };
 
+/*
+	All 65536 opcodes are decoded once at compile time into a table of packed entries;
+	decode() is a lookup plus building the Instruction, and never allocates.
+*/
 class Decoder
 {
 public:
 	Decoder() = default;
 
-	DecodeResult decode(uint16_t address, uint16_t opcode );
+	DecodeResult decode( uint16_t address, uint16_t opcode ) const;
 
-private:
-	using Dispatcher = std::array<DecodeResult (Decoder::*)(uint16_t address, uint16_t opcode), 16>;
-	static Dispatcher dispatcher;
-
-	DecodeResult decode_SYS( uint16_t address, uint16_t opcode );
-	DecodeResult decode_JP( uint16_t address, uint16_t opcode );
-	DecodeResult decode_CALL( uint16_t address, uint16_t opcode );
-	DecodeResult decode_SEI( uint16_t address, uint16_t opcode );
-	DecodeResult decode_SNEI( uint16_t address, uint16_t opcode );
-	DecodeResult decode_SER( uint16_t address, uint16_t opcode );
-	DecodeResult decode_LD( uint16_t address, uint16_t opcode );
-	DecodeResult decode_ADD( uint16_t address, uint16_t opcode );
-	DecodeResult decode_MathOp( uint16_t address, uint16_t opcode );
-	DecodeResult decode_SNE( uint16_t address, uint16_t opcode );
-	DecodeResult decode_LDI( uint16_t address, uint16_t opcode );
-	DecodeResult decode_JMP( uint16_t address, uint16_t opcode );
-	DecodeResult decode_RND( uint16_t address, uint16_t opcode );
-	DecodeResult decode_DRW( uint16_t address, uint16_t opcode );
-	DecodeResult decode_Key( uint16_t address, uint16_t opcode );
-	DecodeResult decode_Misc( uint16_t address, uint16_t opcode );
+	static const DecodeEntry& lookup( uint16_t opcode );
 };
@@ -17,157 +17,136 @@
  * MA 02110-1301, USA.
  */
 
-#include <array>
+#include <algorithm>
 #include <cassert>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 #include "ir/encoder.h"
-#include "encoder.h"
+#include "ir/opcode_table.h"
 
-static const std::array<uint16_t, opcode_count> base =
+namespace {
+
+struct Extent
 {
-	/* OPCODE::NOP */		0x0000,
-	/* Opcode::CLS */		0x00E0,
-	/* Opcode::RET */		0x00EE,
-	/* Opcode::JP */		0x1000,
-	/* Opcode::CALL */		0x2000,
-	/* Opcode::SE_Imm */	0x3000,
-	/* Opcode::SNE_Imm */	0x4000,
-	/* Opcode::SE_Reg */	0x5000,
-	/* Opcode::LD_Imm */	0x6000,
-	/* Opcode::ADD_Imm */	0x7000,
-	/* Opcode::LD_Reg */	0x8000,
-	/* Opcode::OR */		0x8001,
-	/* Opcode::AND */		0x8002,
-	/* Opcode::XOR */		0x8003,
-	/* Opcode::ADD_Reg */	0x8004,
-	/* Opcode::SUB */		0x8005,
-	/* Opcode::SHR */		0x8006,
-	/* Opcode::SUBN */		0x8007,
-	/* Opcode::SHL */		0x800E,
-	/* Opcode::SNE_Reg */	0x9000,
-	/* Opcode::LD_I */		0xA000,
-	/* Opcode::JP_V0 */		0xB000,
-	/* Opcode::RND */		0xC000,
-	/* Opcode::DRW */		0xD000,
-	/* Opcode::SKP */		0xE09E,
-	/* Opcode::SKNP */		0xE0A1,
-	/* Opcode::LD_DT */		0xF015,
-	/* Opcode::LD_ST */		0xF018,
-	/* Opcode::ST_KEY */	0xF00A,
-	/* Opcode::ST_DT */		0xF007,
-	/* Opcode::ADD_I */		0xF01E,
-	/* Opcode::LD_SPRITE */	0xF029,
-	/* Opcode::BCD */		0xF033,
-	/* Opcode::ST_REGS */	0xF055,
-	/* Opcode::LD_REGS */	0xF065,
+	uint32_t begin;
+	uint32_t end;
 };
 
-BinImage BinaryEncoder::encode( const IRProgram &ir )
+uint32_t element_size( const InstructionElement& ) { return 2; }
+uint32_t element_size( const DataElement& data ) { return data.byte_run.size(); }
+
+std::string hex( uint32_t value )
+{
+	std::ostringstream os;
+	os << "0x" << std::hex << std::uppercase << value;
+	return os.str();
+}
+
+// Sizing pass: the extent of every element, checked against the origin and each other
+uint32_t measure( const IRProgram& ir )
+{
+	std::vector<Extent> extents;
+	extents.reserve( ir.elements.size() );
+
+	for( const auto& element : ir.elements ) {
+		const Extent extent = std::visit( []( const auto& v ) { return Extent { v.address, v.address + element_size( v ) }; }, element );
+
+		if( extent.begin < ir.origin )
+			throw std::runtime_error( "Element at " + hex( extent.begin ) + " lies below the origin " + hex( ir.origin ) );
+
+		extents.push_back( extent );
+	}
+
+	if( !std::is_sorted( extents.begin(), extents.end(), []( const Extent& a, const Extent& b ) { return a.begin < b.begin; } ) )
+		std::sort( extents.begin(), extents.end(), []( const Extent& a, const Extent& b ) { return a.begin < b.begin; } );
+
+	uint32_t end = ir.origin;
+
+	for( const Extent& extent : extents ) {
+		if( extent.begin < end )
+			throw std::runtime_error( "Element at " + hex( extent.begin ) + " overlaps the element before it" );
+
+		end = std::max( end, extent.end );
+	}
+
+	return end - ir.origin;
+}
+
+}
+
+size_t BinaryEncoder::image_size( const IRProgram& ir ) const
+{
+	return measure( ir );
+}
+
+BinImage BinaryEncoder::encode( const IRProgram& ir )
 {
-	BinImage image;
+	BinImage image( measure( ir ), configuration.fill );
 
 	for( const auto& element : ir.elements )
-        std::visit( [&]( const auto& v ) { encode_element( v, image ); }, element );
+		std::visit( [&]( const auto& v ) { encode_element( v, image.data() + ( v.address - ir.origin ) ); }, element );
 
 	return image;
 }
 
-void BinaryEncoder::encode_element( const InstructionElement& element, BinImage& image )
+void BinaryEncoder::encode_into( const IRProgram& ir, std::span<uint8_t> image )
 {
-	const auto& opcode = element.instruction.opcode();
-	const auto& operands = element.instruction.operands();
+	const size_t size = measure( ir );
 
-	// uint16_t result = encoding_table.at(opcode).base;
-	uint16_t result = base[ static_cast<size_t>(opcode) ];
+	if( image.size() < size )
+		throw std::runtime_error( "Image buffer holds " + std::to_string( image.size() ) + " bytes, the program needs " + std::to_string( size ) );
 
-	switch( opcode ) {
-	// no operand
-	case Opcode::CLS:
-	case Opcode::RET:
-		assert( operands.size() == 0 );
-		break;
+	std::fill( image.begin(), image.end(), configuration.fill );
 
-	// 1 operand; address
-	case Opcode::JP:
-	case Opcode::CALL:
-	case Opcode::LD_I:
-	case Opcode::JP_V0:
-		assert( operands.size() == 1 );
-		result |= (std::get<Addr>(operands[0]).value);
-		break;
+	for( const auto& element : ir.elements )
+		std::visit( [&]( const auto& v ) { encode_element( v, image.data() + ( v.address - ir.origin ) ); }, element );
+}
 
-	// 1 operand; x register
-	case Opcode::LD_DT:
-	case Opcode::LD_ST:
-	case Opcode::ST_KEY:
-	case Opcode::ST_DT:
-	case Opcode::ADD_I:
-	case Opcode::LD_SPRITE:
-	case Opcode::BCD:
-		assert( operands.size() == 1 );
-		result |= (std::get<Reg>(operands[0]).index << 8);
+void BinaryEncoder::encode_element( const InstructionElement& element, uint8_t * out )
+{
+	const OpcodeInfo& info = opcode_info( element.instruction.opcode() );
+	const auto& operands = element.instruction.operands();
+
+	assert( operands.size() == operand_count( info.layout ) );
+
+	uint16_t result = info.match;
+
+	switch( info.layout ) {
+	case OperandLayout::None:
 		break;
 
-	// 1 operand; key index
-	case Opcode::SKP:
-	case Opcode::SKNP:
-		assert( operands.size() == 1 );
-		result |= (std::get<Reg>(operands[0]).index << 8);
+	case OperandLayout::Address:
+		result |= std::get<Addr>(operands[0]).value;
 		break;
 
-	// 1 operand; register count
-	case Opcode::ST_REGS:
-	case Opcode::LD_REGS:
-		assert( operands.size() == 1 );
+	case OperandLayout::X:
 		result |= (std::get<Reg>(operands[0]).index << 8);
 		break;
 
-	// 2 operands; x register and immediate
-	case Opcode::SE_Imm:
-	case Opcode::SNE_Imm:
-	case Opcode::LD_Imm:
-	case Opcode::ADD_Imm:
-	case Opcode::RND:
-		assert( operands.size() == 2 );
+	case OperandLayout::XByte:
 		result |= (std::get<Reg>(operands[0]).index << 8);
 		result |= (std::get<Imm>(operands[1]).value);
 		break;
 
-	// 2 operands; x register and y register
-	case Opcode::SE_Reg:
-	case Opcode::LD_Reg:
-	case Opcode::OR:
-	case Opcode::AND:
-	case Opcode::XOR:
-	case Opcode::ADD_Reg:
-	case Opcode::SUB:
-	case Opcode::SHR:
-	case Opcode::SUBN:
-	case Opcode::SHL:
-	case Opcode::SNE_Reg:
-		assert( operands.size() == 2 );
+	case OperandLayout::XY:
 		result |= (std::get<Reg>(operands[0]).index << 8);
 		result |= (std::get<Reg>(operands[1]).index << 4);
 		break;
 
-	// 3 operands; x register, y register and nibble
-	case Opcode::DRW:
-		assert( operands.size() == 3 );
+	case OperandLayout::XYNibble:
 		result |= (std::get<Reg>(operands[0]).index << 8);
 		result |= (std::get<Reg>(operands[1]).index << 4);
 		result |= (std::get<Nibble>(operands[2]).value );
 		break;
-
-	default:
-		assert( false && "Unhandled opcode in encoder" );
 	}
 
-	image.push_back( (result >> 8) & 0xFF );
-	image.push_back( (result     ) & 0xFF );
-	return;
+	out[0] = (result >> 8) & 0xFF;
+	out[1] = (result     ) & 0xFF;
 }
 
-void BinaryEncoder::encode_element( const DataElement& element, BinImage& image )
+void BinaryEncoder::encode_element( const DataElement& element, uint8_t * out )
 {
-	image.insert( image.end(), element.byte_run.begin(), element.byte_run.end() );
+	std::copy( element.byte_run.begin(), element.byte_run.end(), out );
 }
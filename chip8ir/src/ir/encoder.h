@@ -19,17 +19,35 @@
 
 #pragma once
 
+#include <span>
+
 #include "ir/chip8ir.h"
 #include "ir/chip8formats.h"
 
+/*
+	Lays each element at its address relative to the program origin. A sizing pass
+	finds the extent and checks that no two elements share a byte, the image is then
+	allocated once and bytes nothing claims hold the fill value.
+*/
 class BinaryEncoder
 {
 public:
+	struct Config {
+		uint8_t fill = 0x00;
+	};
+
 	BinaryEncoder() = default;
 
+	void configure( Config config ) { configuration = std::move(config); };
+
 	BinImage encode( const IRProgram& ir );
 
+	size_t image_size( const IRProgram& ir ) const;						// bytes from origin to the end of the last element
+	void encode_into( const IRProgram& ir, std::span<uint8_t> image );	// caller owned or mapped buffer of at least image_size bytes
+
 private:
-	void encode_element( const InstructionElement& instruction, BinImage& image );
-	void encode_element( const DataElement& data, BinImage& image );
+	Config configuration;
+
+	void encode_element( const InstructionElement& instruction, uint8_t * out );
+	void encode_element( const DataElement& data, uint8_t * out );
 };
@@ -0,0 +1,293 @@
+/*
+ * ir_cache.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "ir/ir_cache.h"
+#include "ir/compact_ir.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <unistd.h>
+
+static_assert( std::endian::native == std::endian::little, "the IR file format is stored little endian" );
+
+namespace {
+
+struct Header
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t origin;
+	uint64_t key;
+	uint32_t instruction_count;
+	uint32_t data_count;
+	uint32_t label_count;
+	uint32_t data_size;
+	uint32_t label_size;
+	uint32_t reserved;
+};
+
+struct LabelRecord
+{
+	uint16_t address;
+	uint16_t length;
+	uint32_t offset;
+};
+
+constexpr char magic[4] = { 'C', '8', 'I', 'R' };
+
+std::atomic<unsigned> writers { 0 };		// numbers the temporary files of this process
+
+static_assert( sizeof( Header ) == 40 && sizeof( DataRun ) == 8 && sizeof( LabelRecord ) == 8 );
+static_assert( std::is_trivially_copyable_v<PackedInstruction> );
+
+template<typename T>
+void append( std::vector<uint8_t>& out, const T * records, size_t count )
+{
+	const uint8_t * bytes = reinterpret_cast<const uint8_t *>( records );
+	out.insert( out.end(), bytes, bytes + count * sizeof( T ) );
+}
+
+}
+
+std::vector<uint8_t> serialise_bundle( const IRBundle& bundle, uint64_t key )
+{
+	const CompactProgram program = compact( bundle.ir );
+
+	std::vector<LabelRecord> records;
+	std::string label_chars;
+
+	if( bundle.resolver ) {
+		LabelTable labels;		// resolvers visit in their own order, the file lists labels by address
+
+		bundle.resolver->for_each_label( [&labels]( uint16_t address, std::string_view label ) { labels.add( address, std::string( label ) ); } );
+
+		labels.for_each_label( [&]( uint16_t address, std::string_view label ) {
+			records.push_back( { address, uint16_t( label.size() ), uint32_t( label_chars.size() ) } );
+			label_chars += label;
+		} );
+	}
+
+	Header header {};
+	std::memcpy( header.magic, magic, sizeof( magic ) );
+	header.version = ir_format_version;
+	header.origin = program.origin;
+	header.key = key;
+	header.instruction_count = program.instructions.size();
+	header.data_count = program.data.size();
+	header.label_count = records.size();
+	header.data_size = program.data_bytes.size();
+	header.label_size = label_chars.size();
+
+	std::vector<uint8_t> out;
+
+	append( out, &header, 1 );
+	append( out, program.instructions.data(), program.instructions.size() );
+	append( out, program.data.data(), program.data.size() );
+	append( out, records.data(), records.size() );
+	append( out, program.data_bytes.data(), program.data_bytes.size() );
+	append( out, label_chars.data(), label_chars.size() );
+
+	return out;
+}
+
+IRBundle deserialise_bundle( std::shared_ptr<const std::vector<uint8_t>> bytes, uint64_t key )
+{
+	Header header;
+
+	if( bytes->size() < sizeof( header ) )
+		throw std::runtime_error( "IR file is truncated" );
+
+	std::memcpy( &header, bytes->data(), sizeof( header ) );
+
+	if( std::memcmp( header.magic, magic, sizeof( magic ) ) != 0 || header.version != ir_format_version )
+		throw std::runtime_error( "Not an IR file of version " + std::to_string( ir_format_version ) );
+
+	if( key && header.key != key )
+		throw std::runtime_error( "IR file was built from different input" );
+
+	const size_t instructions_at = sizeof( Header );
+	const size_t data_at = instructions_at + size_t( header.instruction_count ) * sizeof( PackedInstruction );
+	const size_t labels_at = data_at + size_t( header.data_count ) * sizeof( DataRun );
+	const size_t data_bytes_at = labels_at + size_t( header.label_count ) * sizeof( LabelRecord );
+	const size_t label_chars_at = data_bytes_at + header.data_size;
+
+	if( bytes->size() != label_chars_at + header.label_size )
+		throw std::runtime_error( "IR file is truncated" );
+
+	const PackedInstruction * instructions = reinterpret_cast<const PackedInstruction *>( bytes->data() + instructions_at );
+	const DataRun * runs = reinterpret_cast<const DataRun *>( bytes->data() + data_at );
+	const LabelRecord * records = reinterpret_cast<const LabelRecord *>( bytes->data() + labels_at );
+	const char * label_chars = reinterpret_cast<const char *>( bytes->data() + label_chars_at );
+
+	auto labels = std::make_unique<LabelTable>();
+
+	for( uint32_t index = 0; index < header.label_count; ++index ) {
+		if( size_t( records[index].offset ) + records[index].length > header.label_size )
+			throw std::runtime_error( "IR file has a label outside its table" );
+
+		labels->add( records[index].address, std::string( label_chars + records[index].offset, records[index].length ) );
+	}
+
+	IRBundle bundle { {}, std::move( labels ) };
+	bundle.ir.origin = header.origin;
+	bundle.ir.elements.reserve( header.instruction_count + header.data_count );
+
+	uint32_t instruction = 0;
+	uint32_t run = 0;
+
+	while( instruction < header.instruction_count || run < header.data_count ) {
+
+		if( run == header.data_count || ( instruction < header.instruction_count && instructions[instruction].location() <= runs[run].address ) ) {
+			if( !instructions[instruction].is_valid() )
+				throw std::runtime_error( "IR file has an invalid instruction record" );
+
+			bundle.ir.elements.push_back( InstructionElement { instructions[instruction].location(), instructions[instruction].expand() } );
+			++instruction;
+			continue;
+		}
+
+		if( size_t( runs[run].offset ) + runs[run].length > header.data_size )
+			throw std::runtime_error( "IR file has a data run outside its bytes" );
+
+		bundle.ir.elements.push_back( DataElement { runs[run].address, ByteRun( bytes, data_bytes_at + runs[run].offset, runs[run].length ) } );
+		++run;
+	}
+
+	return bundle;
+}
+
+uint64_t content_key( std::span<const uint8_t> input, uint64_t configuration, uint32_t producer_version )
+{
+	uint64_t hash = 0xCBF29CE484222325;		// FNV-1a
+
+	auto mix = [&hash]( uint8_t byte ) { hash = ( hash ^ byte ) * 0x100000001B3; };
+
+	for( uint8_t byte : input )
+		mix( byte );
+
+	for( unsigned shift = 0; shift < 64; shift += 8 )
+		mix( uint8_t( configuration >> shift ) );
+
+	mix( uint8_t( ir_format_version ) );
+	mix( uint8_t( ir_format_version >> 8 ) );
+
+	for( unsigned shift = 0; shift < 32; shift += 8 )
+		mix( uint8_t( producer_version >> shift ) );
+
+	return hash;
+}
+
+void LabelTable::add( uint16_t address, std::string label )
+{
+	auto it = std::upper_bound( labels.begin(), labels.end(), address,
+								[]( uint16_t value, const std::pair<uint16_t, std::string>& label ) { return value < label.first; } );
+
+	labels.emplace( it, address, std::move( label ) );
+}
+
+std::string LabelTable::get_label( uint16_t address ) const
+{
+	auto it = std::lower_bound( labels.begin(), labels.end(), address,
+								[]( const std::pair<uint16_t, std::string>& label, uint16_t value ) { return label.first < value; } );
+
+	return ( it != labels.end() && it->first == address ) ? it->second : std::string();
+}
+
+void LabelTable::for_each_label( const LabelVisitor& visit ) const
+{
+	for( const auto& [address, label] : labels )
+		visit( address, label );
+}
+
+std::filesystem::path IRCache::default_directory()
+{
+	if( const char * directory = std::getenv( "CHIP8IR_CACHE" ) )
+		return directory;
+
+	if( const char * cache_home = std::getenv( "XDG_CACHE_HOME" ) )
+		return std::filesystem::path( cache_home ) / "chip8ir";
+
+	if( const char * home = std::getenv( "HOME" ) )
+		return std::filesystem::path( home ) / ".cache" / "chip8ir";
+
+	return {};
+}
+
+std::filesystem::path IRCache::path_for( uint64_t key ) const
+{
+	std::ostringstream name;
+	name << std::hex << std::setw( 16 ) << std::setfill( '0' ) << key << ".c8ir";
+
+	return directory / name.str();
+}
+
+// A missing, stale or damaged file is a miss; the caller builds and stores a fresh one
+std::optional<IRBundle> IRCache::load( uint64_t key ) const
+{
+	if( directory.empty() )
+		return std::nullopt;
+
+	std::ifstream is( path_for( key ), std::ios::binary );
+	if( !is )
+		return std::nullopt;
+
+	auto bytes = std::make_shared<std::vector<uint8_t>>( std::istreambuf_iterator<char>( is ), std::istreambuf_iterator<char>() );
+
+	try {
+		return deserialise_bundle( std::move( bytes ), key );
+	}
+	catch( const std::runtime_error& ) {
+		return std::nullopt;
+	}
+}
+
+// Best effort: a cache that cannot be written only costs the next run its shortcut
+void IRCache::store( uint64_t key, const IRBundle& bundle ) const
+{
+	if( directory.empty() )
+		return;
+
+	std::error_code error;
+	std::filesystem::create_directories( directory, error );
+	if( error )
+		return;
+
+	const std::vector<uint8_t> bytes = serialise_bundle( bundle, key );
+	const std::filesystem::path target = path_for( key );
+	std::filesystem::path temporary = target;
+	temporary += "." + std::to_string( ::getpid() ) + "." + std::to_string( ++writers ) + ".tmp";	// concurrent writers of one key
+
+	{
+		std::ofstream os( temporary, std::ios::binary | std::ios::trunc );
+		os.write( reinterpret_cast<const char *>( bytes.data() ), bytes.size() );
+		if( !os )
+			return;
+	}
+
+	std::filesystem::rename( temporary, target, error );		// readers never see half a file
+}
@@ -0,0 +1,92 @@
+/*
+ * ir_cache.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ir/ir_bundle.h"
+
+/*
+	Binary form of an IRBundle. A fixed header is followed by arrays of fixed size
+	records (packed instructions, data runs, label records) and then the data bytes and
+	label characters, all little endian. The rest of the library works on IRProgram,
+	so loading reads the file once and expands the records into elements in address
+	order; only data elements stay in the loaded bytes, as slices of them.
+*/
+constexpr uint16_t ir_format_version = 1;
+
+std::vector<uint8_t> serialise_bundle( const IRBundle& bundle, uint64_t key = 0 );
+IRBundle deserialise_bundle( std::shared_ptr<const std::vector<uint8_t>> bytes, uint64_t key = 0 );	// throws on a bad file
+
+// Identifies a build from its input bytes, whatever configuration shapes the result and the version of its producer
+uint64_t content_key( std::span<const uint8_t> input, uint64_t configuration, uint32_t producer_version );
+
+// The labels of a loaded bundle
+class LabelTable : public ILabelResolver
+{
+public:
+	void add( uint16_t address, std::string label );
+
+	std::string get_label( uint16_t address ) const override;
+	void for_each_label( const LabelVisitor& visit ) const override;
+
+private:
+	std::vector<std::pair<uint16_t, std::string>> labels;		// kept in address order
+};
+
+/*
+	Bundles on disk under the key of what they were built from, so running a tool
+	again on the same ROM skips the build. A cache without a directory never hits.
+*/
+class IRCache
+{
+public:
+	explicit IRCache( std::filesystem::path directory = default_directory() ) : directory( std::move( directory ) ) {}
+
+	// $CHIP8IR_CACHE, else $XDG_CACHE_HOME/chip8ir, else ~/.cache/chip8ir
+	static std::filesystem::path default_directory();
+
+	std::optional<IRBundle> load( uint64_t key ) const;
+	void store( uint64_t key, const IRBundle& bundle ) const;
+
+	template<typename Build>
+	IRBundle get_or_build( uint64_t key, Build build ) const
+	{
+		if( std::optional<IRBundle> cached = load( key ) )
+			return std::move( *cached );
+
+		IRBundle bundle = build();
+		store( key, bundle );
+
+		return bundle;
+	}
+
+private:
+	std::filesystem::path directory;
+
+	std::filesystem::path path_for( uint64_t key ) const;
+};
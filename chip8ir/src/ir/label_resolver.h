@@ -20,12 +20,24 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include <functional>
 
 class ILabelResolver
 {
 public:
+	using LabelVisitor = std::function<void( uint16_t address, std::string_view label )>;
+
 	virtual ~ILabelResolver() = default;
 
 	virtual std::string get_label( uint16_t address ) const = 0;
+
+	// Every labelled address once, with its label. The fallback asks get_label about every address
+	virtual void for_each_label( const LabelVisitor& visit ) const
+	{
+		for( uint32_t address = 0; address <= 0xFFFF; ++address )
+			if( std::string label = get_label( uint16_t( address ) ); !label.empty() )
+				visit( uint16_t( address ), label );
+	}
 };
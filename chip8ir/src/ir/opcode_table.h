@@ -0,0 +1,156 @@
+/*
+ * opcode_table.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "ir/chip8ir.h"
+
+enum class AddressRole : uint8_t
+{
+    None,
+    JumpTarget,
+    SubroutineTarget,
+    ILoadTarget,
+    IndexedBase
+};
+
+// Where control goes after an instruction, relative to its own address
+enum class Successors : uint8_t
+{
+	Invalid,		// not an instruction, decoded as NOP falling through
+	Next,
+	NextOrSkip,
+	Target,
+	NextAndTarget,	// CALL returns to the next instruction
+	None			// RET
+};
+
+// Which fields of the word an instruction takes its operands from, in operand order
+enum class OperandLayout : uint8_t
+{
+	None,
+	X,				// -x--
+	Address,		// -nnn
+	XByte,			// -xkk
+	XY,				// -xy-
+	XYNibble		// -xyn
+};
+
+/*
+	Everything known about an opcode, one row each. The decoder, encoder, emitters and
+	the assembler are built from these rows and nothing else.
+
+	The syntax lists the assembly operands in order. "Vx", "Vy", "kk", "n" and "nnn"
+	stand for the instruction's operands, any other token is written as is.
+*/
+struct OpcodeInfo
+{
+	Opcode opcode;
+	uint16_t mask;							// the bits that identify the opcode
+	uint16_t match;							// and their value
+	OperandLayout layout;
+	Successors successors;
+	AddressRole role;
+	std::string_view name;					// unique per opcode, used in dumps and graphs
+	std::string_view mnemonic;
+	std::array<const char *, 3> syntax;		// unused slots are null
+};
+
+inline constexpr std::array<OpcodeInfo, opcode_count> opcode_table =
+{{
+	{ Opcode::NOP,       0xFFFF, 0x0000, OperandLayout::None,     Successors::Invalid,       AddressRole::None,             "NOP",    "NOP",  {} },
+	{ Opcode::CLS,       0xFFFF, 0x00E0, OperandLayout::None,     Successors::Next,          AddressRole::None,             "CLS",    "CLS",  {} },
+	{ Opcode::RET,       0xFFFF, 0x00EE, OperandLayout::None,     Successors::None,          AddressRole::None,             "RET",    "RET",  {} },
+	{ Opcode::JP,        0xF000, 0x1000, OperandLayout::Address,  Successors::Target,        AddressRole::JumpTarget,       "JP",     "JP",   { "nnn" } },
+	{ Opcode::CALL,      0xF000, 0x2000, OperandLayout::Address,  Successors::NextAndTarget, AddressRole::SubroutineTarget, "CALL",   "CALL", { "nnn" } },
+	{ Opcode::SE_Imm,    0xF000, 0x3000, OperandLayout::XByte,    Successors::NextOrSkip,    AddressRole::None,             "SE",     "SE",   { "Vx", "kk" } },
+	{ Opcode::SNE_Imm,   0xF000, 0x4000, OperandLayout::XByte,    Successors::NextOrSkip,    AddressRole::None,             "SNE",    "SNE",  { "Vx", "kk" } },
+	{ Opcode::SE_Reg,    0xF00F, 0x5000, OperandLayout::XY,       Successors::NextOrSkip,    AddressRole::None,             "SE",     "SE",   { "Vx", "Vy" } },
+	{ Opcode::LD_Imm,    0xF000, 0x6000, OperandLayout::XByte,    Successors::Next,          AddressRole::None,             "LD",     "LD",   { "Vx", "kk" } },
+	{ Opcode::ADD_Imm,   0xF000, 0x7000, OperandLayout::XByte,    Successors::Next,          AddressRole::None,             "ADD",    "ADD",  { "Vx", "kk" } },
+	{ Opcode::LD_Reg,    0xF00F, 0x8000, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "LD",     "LD",   { "Vx", "Vy" } },
+	{ Opcode::OR,        0xF00F, 0x8001, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "OR",     "OR",   { "Vx", "Vy" } },
+	{ Opcode::AND,       0xF00F, 0x8002, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "AND",    "AND",  { "Vx", "Vy" } },
+	{ Opcode::XOR,       0xF00F, 0x8003, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "XOR",    "XOR",  { "Vx", "Vy" } },
+	{ Opcode::ADD_Reg,   0xF00F, 0x8004, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "ADD",    "ADD",  { "Vx", "Vy" } },
+	{ Opcode::SUB,       0xF00F, 0x8005, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "SUB",    "SUB",  { "Vx", "Vy" } },
+	{ Opcode::SHR,       0xF00F, 0x8006, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "SHR",    "SHR",  { "Vx", "Vy" } },
+	{ Opcode::SUBN,      0xF00F, 0x8007, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "SUBN",   "SUBN", { "Vx", "Vy" } },
+	{ Opcode::SHL,       0xF00F, 0x800E, OperandLayout::XY,       Successors::Next,          AddressRole::None,             "SHL",    "SHL",  { "Vx", "Vy" } },
+	{ Opcode::SNE_Reg,   0xF00F, 0x9000, OperandLayout::XY,       Successors::NextOrSkip,    AddressRole::None,             "SNE",    "SNE",  { "Vx", "Vy" } },
+	{ Opcode::LD_I,      0xF000, 0xA000, OperandLayout::Address,  Successors::Next,          AddressRole::ILoadTarget,      "LD I",   "LD",   { "I", "nnn" } },
+
+	// V0 is unknown here, so the table base is all that can be followed; the entries are resolved higher up
+	{ Opcode::JP_V0,     0xF000, 0xB000, OperandLayout::Address,  Successors::Target,        AddressRole::IndexedBase,      "JP V0",  "JP",   { "V0", "nnn" } },
+	{ Opcode::RND,       0xF000, 0xC000, OperandLayout::XByte,    Successors::Next,          AddressRole::None,             "RND",    "RND",  { "Vx", "kk" } },
+	{ Opcode::DRW,       0xF000, 0xD000, OperandLayout::XYNibble, Successors::Next,          AddressRole::None,             "DRW",    "DRW",  { "Vx", "Vy", "n" } },
+	{ Opcode::SKP,       0xF0FF, 0xE09E, OperandLayout::X,        Successors::NextOrSkip,    AddressRole::None,             "SKP",    "SKP",  { "Vx" } },
+	{ Opcode::SKNP,      0xF0FF, 0xE0A1, OperandLayout::X,        Successors::NextOrSkip,    AddressRole::None,             "SKNP",   "SKNP", { "Vx" } },
+	{ Opcode::LD_DT,     0xF0FF, 0xF015, OperandLayout::X,        Successors::Next,          AddressRole::None,             "LD DT",  "LD",   { "DT", "Vx" } },
+	{ Opcode::LD_ST,     0xF0FF, 0xF018, OperandLayout::X,        Successors::Next,          AddressRole::None,             "LD ST",  "LD",   { "ST", "Vx" } },
+	{ Opcode::ST_KEY,    0xF0FF, 0xF00A, OperandLayout::X,        Successors::Next,          AddressRole::None,             "ST K",   "LD",   { "Vx", "K" } },
+	{ Opcode::ST_DT,     0xF0FF, 0xF007, OperandLayout::X,        Successors::Next,          AddressRole::None,             "ST DT",  "LD",   { "Vx", "DT" } },
+	{ Opcode::ADD_I,     0xF0FF, 0xF01E, OperandLayout::X,        Successors::Next,          AddressRole::None,             "ADD I",  "ADD",  { "I", "Vx" } },
+	{ Opcode::LD_SPRITE, 0xF0FF, 0xF029, OperandLayout::X,        Successors::Next,          AddressRole::None,             "LD F",   "LD",   { "F", "Vx" } },
+	{ Opcode::BCD,       0xF0FF, 0xF033, OperandLayout::X,        Successors::Next,          AddressRole::None,             "LD B",   "LD",   { "B", "Vx" } },
+	{ Opcode::ST_REGS,   0xF0FF, 0xF055, OperandLayout::X,        Successors::Next,          AddressRole::None,             "ST [I]", "LD",   { "[I]", "Vx" } },
+	{ Opcode::LD_REGS,   0xF0FF, 0xF065, OperandLayout::X,        Successors::Next,          AddressRole::None,             "LD [I]", "LD",   { "Vx", "[I]" } },
+}};
+
+constexpr const OpcodeInfo& opcode_info( Opcode opcode ) { return opcode_table[ static_cast<size_t>( opcode ) ]; }
+
+constexpr bool is_operand_token( std::string_view token )
+{
+	return token == "Vx" || token == "Vy" || token == "kk" || token == "n" || token == "nnn";
+}
+
+constexpr size_t operand_count( OperandLayout layout )
+{
+	switch( layout ) {
+	case OperandLayout::None:     return 0;
+	case OperandLayout::X:        return 1;
+	case OperandLayout::Address:  return 1;
+	case OperandLayout::XByte:    return 2;
+	case OperandLayout::XY:       return 2;
+	case OperandLayout::XYNibble: return 3;
+	}
+	return 0;
+}
+
+// Rows sit at their opcode's index, match only bits under their mask and list one syntax token per operand
+constexpr bool opcode_table_is_consistent()
+{
+	for( size_t index = 0; index < opcode_table.size(); ++index ) {
+		const OpcodeInfo& row = opcode_table[index];
+		size_t operands = 0;
+
+		for( const char * token : row.syntax )
+			operands += token && is_operand_token( token );
+
+		if( static_cast<size_t>( row.opcode ) != index || ( row.match & ~row.mask ) || operands != operand_count( row.layout ) )
+			return false;
+	}
+	return true;
+}
+
+static_assert( opcode_table_is_consistent() );
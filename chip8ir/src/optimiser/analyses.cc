@@ -0,0 +1,312 @@
+/*
+ * analyses.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "optimiser/analyses.h"
+
+#include <algorithm>
+#include <iterator>
+
+Liveness::Value Liveness::transfer( const InstructionElement& element, Value live ) const
+{
+	const RegisterUse use = register_use( element.instruction );
+
+	return RegisterSet( ( live & ~use.writes ) | use.reads );
+}
+
+ReachingDefinitions::Value ReachingDefinitions::meet( const Value& a, const Value& b ) const
+{
+	Value result;
+
+	for( size_t r = 0; r < 16; ++r )
+		std::set_union( a.sites[r].begin(), a.sites[r].end(), b.sites[r].begin(), b.sites[r].end(), std::back_inserter( result.sites[r] ) );
+
+	result.outside = a.outside | b.outside;
+
+	return result;
+}
+
+ReachingDefinitions::Value ReachingDefinitions::transfer( const InstructionElement& element, Value definitions ) const
+{
+	const RegisterUse use = register_use( element.instruction );
+
+	for( size_t r = 0; r < 16; ++r ) {
+		std::vector<uint16_t>& sites = definitions.sites[r];
+
+		if( use.writes & ( 1u << r ) ) {
+			sites.assign( 1, element.address );
+			definitions.outside &= ~( 1u << r );
+		}
+		else if( use.clobbers & ( 1u << r ) ) {
+			auto it = std::lower_bound( sites.begin(), sites.end(), element.address );
+			if( it == sites.end() || *it != element.address )
+				sites.insert( it, element.address );
+		}
+	}
+
+	return definitions;
+}
+
+using eState = RegisterValue::eState;
+
+static constexpr RegisterValue varying { eState::VARYING, 0 };
+
+static RegisterValue constant( unsigned value ) { return { eState::CONSTANT, uint8_t( value ) }; }
+
+// The state of a result computed from both operands when at least one is not a constant
+static RegisterValue unknown( const RegisterValue& a, const RegisterValue& b )
+{
+	if( a.state == eState::VARYING || b.state == eState::VARYING )
+		return varying;
+
+	return { eState::UNDEFINED, 0 };
+}
+
+static bool both_constant( const RegisterValue& a, const RegisterValue& b )
+{
+	return a.state == eState::CONSTANT && b.state == eState::CONSTANT;
+}
+
+ConstantPropagation::Value ConstantPropagation::boundary() const
+{
+	Value value;
+	value.registers.fill( varying );
+	return value;
+}
+
+ConstantPropagation::Value ConstantPropagation::meet( const Value& a, const Value& b ) const
+{
+	Value result;
+
+	for( size_t r = 0; r < 16; ++r ) {
+		const RegisterValue& x = a.registers[r];
+		const RegisterValue& y = b.registers[r];
+
+		if( x.state == eState::UNDEFINED )
+			result.registers[r] = y;
+		else if( y.state == eState::UNDEFINED || x == y )
+			result.registers[r] = x;
+		else
+			result.registers[r] = varying;
+	}
+
+	return result;
+}
+
+ConstantPropagation::Value ConstantPropagation::transfer( const InstructionElement& element, Value constants ) const
+{
+	const Instruction& instruction = element.instruction;
+	const auto& operands = instruction.operands();
+	auto& registers = constants.registers;
+
+	auto reg = [&]( size_t operand ) -> RegisterValue& { return registers[std::get<Reg>( operands[operand] ).index]; };
+
+	switch( instruction.opcode() ) {
+	case Opcode::LD_Imm:
+		reg( 0 ) = constant( std::get<Imm>( operands[1] ).value );
+		return constants;
+
+	case Opcode::ADD_Imm:
+		if( reg( 0 ).state == eState::CONSTANT )
+			reg( 0 ) = constant( reg( 0 ).value + std::get<Imm>( operands[1] ).value );
+		return constants;
+
+	case Opcode::LD_Reg:
+		reg( 0 ) = reg( 1 );
+		return constants;
+
+	case Opcode::ADD_Reg:
+	case Opcode::SUB:
+	case Opcode::SUBN:
+		{
+			const RegisterValue x = reg( 0 );
+			const RegisterValue y = reg( 1 );
+
+			if( !both_constant( x, y ) ) {
+				reg( 0 ) = registers[0xF] = unknown( x, y );
+				return constants;
+			}
+
+			switch( instruction.opcode() ) {
+			case Opcode::ADD_Reg: reg( 0 ) = constant( x.value + y.value ); registers[0xF] = constant( x.value + y.value > 0xFF ); break;
+			case Opcode::SUB:     reg( 0 ) = constant( x.value - y.value ); registers[0xF] = constant( x.value >= y.value ); break;
+			default:              reg( 0 ) = constant( y.value - x.value ); registers[0xF] = constant( y.value >= x.value ); break;
+			}
+			return constants;
+		}
+
+	case Opcode::OR:
+	case Opcode::AND:
+	case Opcode::XOR:
+		{
+			const RegisterValue x = reg( 0 );
+			const RegisterValue y = reg( 1 );
+
+			if( !both_constant( x, y ) )
+				reg( 0 ) = unknown( x, y );
+			else if( instruction.opcode() == Opcode::OR )
+				reg( 0 ) = constant( x.value | y.value );
+			else if( instruction.opcode() == Opcode::AND )
+				reg( 0 ) = constant( x.value & y.value );
+			else
+				reg( 0 ) = constant( x.value ^ y.value );
+
+			registers[0xF] = varying;
+			return constants;
+		}
+
+	default:
+		break;
+	}
+
+	// Everything else that writes a register leaves a value we cannot know here
+	const RegisterUse use = register_use( instruction );
+
+	for( size_t r = 0; r < 16; ++r )
+		if( ( use.writes | use.clobbers ) & ( 1u << r ) )
+			registers[r] = varying;
+
+	return constants;
+}
+
+using ValueSet = std::bitset<256>;
+
+static ValueSet single( unsigned value ) { return ValueSet().set( value & 0xFF ); }
+
+// Applies an operation to every pair of values, giving up when there are too many pairs
+template<typename Operation>
+static ValueSet combine( const ValueSet& a, const ValueSet& b, Operation operation )
+{
+	if( a.none() || b.none() )
+		return {};
+
+	if( a.count() * b.count() > 4096 )
+		return ValueSet().set();
+
+	ValueSet result;
+
+	for( unsigned x = 0; x < 256; ++x )
+		if( a[x] )
+			for( unsigned y = 0; y < 256; ++y )
+				if( b[y] )
+					result.set( operation( x, y ) & 0xFF );
+
+	return result;
+}
+
+ValueSetAnalysis::Value ValueSetAnalysis::boundary() const
+{
+	Value value;
+	for( ValueSet& set : value.registers )
+		set.set();
+	return value;
+}
+
+ValueSetAnalysis::Value ValueSetAnalysis::meet( const Value& a, const Value& b ) const
+{
+	Value result;
+
+	for( size_t r = 0; r < 16; ++r )
+		result.registers[r] = a.registers[r] | b.registers[r];
+
+	return result;
+}
+
+ValueSetAnalysis::Value ValueSetAnalysis::transfer( const InstructionElement& element, Value sets ) const
+{
+	const Instruction& instruction = element.instruction;
+	const auto& operands = instruction.operands();
+	auto& registers = sets.registers;
+
+	auto reg = [&]( size_t operand ) -> ValueSet& { return registers[std::get<Reg>( operands[operand] ).index]; };
+	auto imm = [&]() { return single( std::get<Imm>( operands[1] ).value ); };
+
+	// The result goes to Vx and the flag to VF, when Vx is VF either may be what stays
+	auto arithmetic = [&]( const ValueSet& result, const ValueSet& flag ) {
+		const bool into_vf = std::get<Reg>( operands[0] ).index == 0xF;
+		reg( 0 ) = result;
+		registers[0xF] = into_vf ? ( result | flag ) : flag;
+	};
+
+	switch( instruction.opcode() ) {
+	case Opcode::LD_Imm:  reg( 0 ) = imm(); return sets;
+	case Opcode::ADD_Imm: reg( 0 ) = combine( reg( 0 ), imm(), []( unsigned x, unsigned y ) { return x + y; } ); return sets;
+	case Opcode::LD_Reg:  reg( 0 ) = reg( 1 ); return sets;
+	case Opcode::RND:     reg( 0 ) = combine( ValueSet().set(), imm(), []( unsigned x, unsigned y ) { return x & y; } ); return sets;
+	case Opcode::ST_KEY:  reg( 0 ) = ValueSet( 0xFFFF ); return sets;
+
+	case Opcode::OR:
+	case Opcode::AND:
+	case Opcode::XOR:
+		{
+			const Opcode opcode = instruction.opcode();
+			reg( 0 ) = combine( reg( 0 ), reg( 1 ), [opcode]( unsigned x, unsigned y ) {
+				return ( opcode == Opcode::OR ) ? ( x | y ) : ( opcode == Opcode::AND ) ? ( x & y ) : ( x ^ y );
+			} );
+			registers[0xF].set( 0 );		// some interpreters clear VF
+			return sets;
+		}
+
+	case Opcode::ADD_Reg:
+		{
+			const ValueSet x = reg( 0 ), y = reg( 1 );
+			arithmetic( combine( x, y, []( unsigned a, unsigned b ) { return a + b; } ),
+						combine( x, y, []( unsigned a, unsigned b ) { return unsigned( a + b > 0xFF ); } ) );
+			return sets;
+		}
+
+	case Opcode::SUB:
+	case Opcode::SUBN:
+		{
+			const ValueSet x = ( instruction.opcode() == Opcode::SUB ) ? reg( 0 ) : reg( 1 );
+			const ValueSet y = ( instruction.opcode() == Opcode::SUB ) ? reg( 1 ) : reg( 0 );
+			arithmetic( combine( x, y, []( unsigned a, unsigned b ) { return a - b; } ),
+						combine( x, y, []( unsigned a, unsigned b ) { return unsigned( a >= b ); } ) );
+			return sets;
+		}
+
+	case Opcode::SHR:
+	case Opcode::SHL:
+		{
+			// Shifts Vy on the original interpreter and Vx on later ones
+			const ValueSet source = reg( 0 ) | reg( 1 );
+			if( instruction.opcode() == Opcode::SHR )
+				arithmetic( combine( source, single( 1 ), []( unsigned a, unsigned b ) { return a >> b; } ),
+							combine( source, single( 1 ), []( unsigned a, unsigned b ) { return a & b; } ) );
+			else
+				arithmetic( combine( source, single( 1 ), []( unsigned a, unsigned b ) { return a << b; } ),
+							combine( source, single( 7 ), []( unsigned a, unsigned b ) { return a >> b; } ) );
+			return sets;
+		}
+
+	case Opcode::DRW:
+		registers[0xF] = ValueSet( 0b11 );
+		return sets;
+
+	default:
+		break;
+	}
+
+	const RegisterUse use = register_use( instruction );
+
+	for( size_t r = 0; r < 16; ++r )
+		if( ( use.writes | use.clobbers ) & ( 1u << r ) )
+			registers[r].set();
+
+	return sets;
+}
@@ -0,0 +1,122 @@
+/*
+ * analyses.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "optimiser/dataflow.h"
+
+// Registers some path from a point reads before writing them
+struct Liveness
+{
+	using Value = RegisterSet;
+	static constexpr Direction direction = Direction::Backward;
+
+	Value boundary() const { return all_registers; }	// whoever we return or jump to may read anything
+	Value initial() const { return 0; }
+	Value meet( Value a, Value b ) const { return a | b; }
+	Value transfer( const InstructionElement& element, Value live ) const;
+};
+
+// For each register, the instructions whose write of it may still be there
+struct Definitions
+{
+	std::array<std::vector<uint16_t>, 16> sites;		// ascending addresses
+	RegisterSet outside = 0;							// may still hold what it held when control entered the graph
+
+	bool operator==( const Definitions& ) const = default;
+};
+
+struct ReachingDefinitions
+{
+	using Value = Definitions;
+	static constexpr Direction direction = Direction::Forward;
+
+	Value boundary() const { return { {}, all_registers }; }
+	Value initial() const { return {}; }
+	Value meet( const Value& a, const Value& b ) const;
+	Value transfer( const InstructionElement& element, Value definitions ) const;
+};
+
+// What a register holds: not yet known, one value on every path, or more than one
+struct RegisterValue
+{
+	enum class eState : uint8_t { UNDEFINED, CONSTANT, VARYING };
+
+	eState state = eState::UNDEFINED;
+	uint8_t value = 0;
+
+	bool operator==( const RegisterValue& ) const = default;
+};
+
+struct RegisterConstants
+{
+	std::array<RegisterValue, 16> registers;
+
+	std::optional<uint8_t> constant( Reg reg ) const
+	{
+		const RegisterValue& v = registers[reg.index];
+		return ( v.state == RegisterValue::eState::CONSTANT ) ? std::optional<uint8_t>( v.value ) : std::nullopt;
+	}
+
+	bool operator==( const RegisterConstants& ) const = default;
+};
+
+/*
+	Folds loads and arithmetic on known values; VF follows ADD, SUB and SUBN. Whatever
+	differs between interpreters, the shift source and the VF of OR, AND and XOR, varies.
+*/
+struct ConstantPropagation
+{
+	using Value = RegisterConstants;
+	static constexpr Direction direction = Direction::Forward;
+
+	Value boundary() const;
+	Value initial() const { return {}; }
+	Value meet( const Value& a, const Value& b ) const;
+	Value transfer( const InstructionElement& element, Value constants ) const;
+};
+
+// Every value a register may hold, a bit per value
+struct ValueSets
+{
+	std::array<std::bitset<256>, 16> registers;
+
+	bool operator==( const ValueSets& ) const = default;
+};
+
+/*
+	Value-set analysis. Sets are joined by union, so a register nothing pins down ends up
+	holding all 256 values. Where interpreters differ the set holds what any of them gives.
+*/
+struct ValueSetAnalysis
+{
+	using Value = ValueSets;
+	static constexpr Direction direction = Direction::Forward;
+
+	Value boundary() const;
+	Value initial() const { return {}; }
+	Value meet( const Value& a, const Value& b ) const;
+	Value transfer( const InstructionElement& element, Value sets ) const;
+};
@@ -0,0 +1,182 @@
+/*
+ * dataflow.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "optimiser/dataflow.h"
+
+#include "ir/opcode_table.h"
+
+#include <algorithm>
+
+static RegisterSet bit( Reg reg ) { return RegisterSet( 1u << reg.index ); }
+static RegisterSet up_to( Reg reg ) { return RegisterSet( ( 2u << reg.index ) - 1 ); }
+
+RegisterUse register_use( const Instruction& instruction )
+{
+	const auto& operands = instruction.operands();
+	const RegisterSet vf = 1u << 0xF;
+
+	auto x = [&]() { return bit( std::get<Reg>( operands[0] ) ); };
+	auto y = [&]() { return bit( std::get<Reg>( operands[1] ) ); };
+
+	switch( instruction.opcode() ) {
+	case Opcode::SE_Imm:
+	case Opcode::SNE_Imm:
+	case Opcode::SKP:
+	case Opcode::SKNP:
+	case Opcode::LD_DT:
+	case Opcode::LD_ST:
+	case Opcode::ADD_I:
+	case Opcode::LD_SPRITE:
+	case Opcode::BCD:       return { x(), 0 };
+
+	case Opcode::SE_Reg:
+	case Opcode::SNE_Reg:   return { RegisterSet( x() | y() ), 0 };
+
+	case Opcode::LD_Imm:
+	case Opcode::RND:
+	case Opcode::ST_KEY:
+	case Opcode::ST_DT:     return { 0, x() };
+
+	case Opcode::ADD_Imm:   return { x(), x() };
+	case Opcode::LD_Reg:    return { y(), x() };
+
+	case Opcode::OR:
+	case Opcode::AND:
+	case Opcode::XOR:       return { RegisterSet( x() | y() ), x(), vf };
+
+	case Opcode::ADD_Reg:
+	case Opcode::SUB:
+	case Opcode::SUBN:
+	case Opcode::SHR:
+	case Opcode::SHL:       return { RegisterSet( x() | y() ), RegisterSet( x() | vf ) };
+
+	case Opcode::DRW:       return { RegisterSet( x() | y() ), vf };
+	case Opcode::JP_V0:     return { 1, 0 };
+	case Opcode::CALL:      return { all_registers, 0, all_registers };
+
+	case Opcode::ST_REGS:   return { up_to( std::get<Reg>( operands[0] ) ), 0 };
+	case Opcode::LD_REGS:   return { 0, up_to( std::get<Reg>( operands[0] ) ) };
+
+	default:                return {};
+	}
+}
+
+BlockGraph::BlockGraph( const IRProgram& ir ) : index_( 0x10000, none )
+{
+	for( const ASMElement& element : ir.elements )
+		if( const InstructionElement * instruction = std::get_if<InstructionElement>( &element ) )
+			instructions_.push_back( instruction );
+
+	std::sort( instructions_.begin(), instructions_.end(),
+			   []( const InstructionElement * a, const InstructionElement * b ) { return a->address < b->address; } );
+
+	for( uint32_t i = 0; i < instructions_.size(); ++i )
+		index_[instructions_[i]->address] = i;
+
+	const uint32_t count = instructions_.size();
+	std::vector<bool> leader( count );
+	std::vector<bool> entry( count );
+
+	auto mark = [&]( std::vector<bool>& marks, uint32_t address ) {
+		if( address < index_.size() && index_[address] != none )
+			marks[index_[address]] = true;
+	};
+
+	mark( leader, ir.origin );
+	mark( entry, ir.origin );
+
+	for( uint32_t i = 0; i < count; ++i ) {
+		const InstructionElement& element = *instructions_[i];
+		const OpcodeInfo& info = opcode_info( element.instruction.opcode() );
+		const uint32_t next = element.address + 2;
+
+		if( i == 0 || instructions_[i - 1]->address + 2 != element.address )
+			leader[i] = true;
+
+		if( info.successors != Successors::Next && info.successors != Successors::Invalid )
+			mark( leader, next );
+
+		if( info.successors == Successors::NextOrSkip )
+			mark( leader, next + 2 );
+
+		if( info.role == AddressRole::JumpTarget || info.role == AddressRole::SubroutineTarget || info.role == AddressRole::IndexedBase ) {
+			const uint16_t target = std::get<Addr>( element.instruction.operands()[0] ).value;
+
+			mark( leader, target );
+			if( info.role != AddressRole::JumpTarget )
+				mark( entry, target );
+		}
+	}
+
+	for( uint32_t i = 0; i < count; ++i ) {
+		if( leader[i] ) {
+			blocks_.emplace_back();
+			blocks_.back().first = i;
+		}
+
+		blocks_.back().last = i + 1;
+		blocks_.back().entry = blocks_.back().entry || entry[i];
+		block_.push_back( blocks_.size() - 1 );
+	}
+
+	for( uint32_t b = 0; b < blocks_.size(); ++b ) {
+		Block& block = blocks_[b];
+		const InstructionElement& last = *instructions_[block.last - 1];
+		const uint32_t next = last.address + 2;
+
+		auto link = [&]( uint32_t address ) {
+			if( address < index_.size() && index_[address] != none ) {
+				const uint32_t successor = block_[index_[address]];
+				block.successors.push_back( successor );
+				blocks_[successor].predecessors.push_back( b );
+			}
+			else
+				block.exit = true;
+		};
+
+		switch( opcode_info( last.instruction.opcode() ).successors ) {
+		case Successors::Invalid:
+		case Successors::Next:
+		case Successors::NextAndTarget:			// the routine is an entry, the call returns here
+			link( next );
+			break;
+
+		case Successors::NextOrSkip:
+			link( next );
+			link( next + 2 );
+			break;
+
+		case Successors::Target:
+			if( last.instruction.opcode() == Opcode::JP )
+				link( std::get<Addr>( last.instruction.operands()[0] ).value );
+			else
+				block.exit = true;
+			break;
+
+		case Successors::None:
+			block.exit = true;
+			break;
+		}
+	}
+
+	// Whatever nothing flows into, a JP V0 table entry or dead code, starts from the unknown
+	for( Block& block : blocks_ )
+		if( block.predecessors.empty() )
+			block.entry = true;
+}
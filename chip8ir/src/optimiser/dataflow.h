@@ -0,0 +1,217 @@
+/*
+ * dataflow.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ir/chip8ir.h"
+
+// V registers as bits, V0 in bit 0
+using RegisterSet = uint16_t;
+
+constexpr RegisterSet all_registers = 0xFFFF;
+
+struct RegisterUse
+{
+	RegisterSet reads = 0;
+	RegisterSet writes = 0;		// always written
+	RegisterSet clobbers = 0;	// may be written: VF by OR, AND and XOR on some interpreters, everything by a CALL
+};
+
+RegisterUse register_use( const Instruction& instruction );
+
+/*
+	The instructions of a program cut into basic blocks. Only a block's last instruction
+	branches and only its first is landed on. A CALL ends its block and flows to the
+	instruction after it; the routine it calls is an entry of its own. Flow the graph
+	cannot follow, a RET, a JP V0 or running into bytes that are not code, makes the
+	block an exit.
+*/
+class BlockGraph
+{
+public:
+	struct Block
+	{
+		uint32_t first = 0;		// instruction indices, last one excluded
+		uint32_t last = 0;
+		bool entry = false;		// control arrives from outside the graph
+		bool exit = false;		// control leaves the graph
+		std::vector<uint32_t> successors;
+		std::vector<uint32_t> predecessors;
+	};
+
+	explicit BlockGraph( const IRProgram& ir );
+
+	const std::vector<Block>& blocks() const { return blocks_; }
+	const std::vector<const InstructionElement *>& instructions() const { return instructions_; }
+
+	static constexpr uint32_t none = UINT32_MAX;
+
+	uint32_t instruction_index( uint16_t address ) const { return index_[address]; }
+	uint32_t block_of( uint32_t instruction ) const { return block_[instruction]; }
+
+private:
+	std::vector<const InstructionElement *> instructions_;		// in address order
+	std::vector<uint32_t> index_;								// instruction by address
+	std::vector<uint32_t> block_;								// block by instruction
+	std::vector<Block> blocks_;
+};
+
+enum class Direction { Forward, Backward };
+
+/*
+	Worklist solver over a BlockGraph. An analysis provides
+
+		using Value;
+		static constexpr Direction direction;
+		Value boundary() const;							// where control enters (forward) or leaves (backward)
+		Value initial() const;							// the optimistic start for every other block
+		Value meet( const Value&, const Value& ) const;
+		Value transfer( const InstructionElement&, Value ) const;
+
+	Values are kept per block; asking for one at an instruction replays its block up to it.
+*/
+template<typename Analysis>
+class DataFlow
+{
+public:
+	using Value = typename Analysis::Value;
+
+	DataFlow( const BlockGraph& graph, Analysis analysis = {} );
+
+	// The value just before and just after the instruction at an address
+	Value before( uint16_t address ) const;
+	Value after( uint16_t address ) const;
+
+	const Value& block_in( uint32_t block ) const { return in[block]; }
+	const Value& block_out( uint32_t block ) const { return out[block]; }
+
+private:
+	const BlockGraph& graph;
+	Analysis analysis;
+	std::vector<Value> in;
+	std::vector<Value> out;
+
+	void solve();
+	Value replay( uint32_t instruction, bool include ) const;
+};
+
+template<typename Analysis>
+DataFlow<Analysis>::DataFlow( const BlockGraph& graph, Analysis analysis ) :
+	graph( graph ), analysis( std::move( analysis ) ),
+	in( graph.blocks().size(), this->analysis.initial() ), out( graph.blocks().size(), this->analysis.initial() )
+{
+	solve();
+}
+
+template<typename Analysis>
+void DataFlow<Analysis>::solve()
+{
+	constexpr bool forward = Analysis::direction == Direction::Forward;
+
+	const auto& blocks = graph.blocks();
+	const auto& instructions = graph.instructions();
+
+	std::vector<uint32_t> worklist;
+	std::vector<bool> queued( blocks.size(), true );
+
+	// Popped from the back, so forward analyses start at the lowest address
+	worklist.reserve( blocks.size() );
+	for( uint32_t i = 0; i < blocks.size(); ++i )
+		worklist.push_back( forward ? uint32_t( blocks.size() - 1 - i ) : i );
+
+	while( !worklist.empty() ) {
+		const uint32_t b = worklist.back();
+		worklist.pop_back();
+		queued[b] = false;
+
+		const auto& block = blocks[b];
+
+		if constexpr( forward ) {
+			Value value = block.entry ? analysis.boundary() : analysis.initial();
+			for( uint32_t p : block.predecessors )
+				value = analysis.meet( value, out[p] );
+			in[b] = value;
+
+			for( uint32_t i = block.first; i < block.last; ++i )
+				value = analysis.transfer( *instructions[i], std::move( value ) );
+
+			if( value == out[b] )
+				continue;
+			out[b] = std::move( value );
+
+			for( uint32_t s : block.successors )
+				if( !queued[s] ) { queued[s] = true; worklist.push_back( s ); }
+		}
+		else {
+			Value value = block.exit ? analysis.boundary() : analysis.initial();
+			for( uint32_t s : block.successors )
+				value = analysis.meet( value, in[s] );
+			out[b] = value;
+
+			for( uint32_t i = block.last; i-- > block.first; )
+				value = analysis.transfer( *instructions[i], std::move( value ) );
+
+			if( value == in[b] )
+				continue;
+			in[b] = std::move( value );
+
+			for( uint32_t p : block.predecessors )
+				if( !queued[p] ) { queued[p] = true; worklist.push_back( p ); }
+		}
+	}
+}
+
+// The value before the instruction (include false) or after it (include true), in execution order
+template<typename Analysis>
+typename DataFlow<Analysis>::Value DataFlow<Analysis>::replay( uint32_t instruction, bool include ) const
+{
+	const auto& instructions = graph.instructions();
+	const uint32_t b = graph.block_of( instruction );
+	const auto& block = graph.blocks()[b];
+
+	if constexpr( Analysis::direction == Direction::Forward ) {
+		Value value = in[b];
+		for( uint32_t i = block.first; i < instruction + include; ++i )
+			value = analysis.transfer( *instructions[i], std::move( value ) );
+		return value;
+	}
+	else {
+		Value value = out[b];
+		for( uint32_t i = block.last; i-- > instruction + include; )
+			value = analysis.transfer( *instructions[i], std::move( value ) );
+		return value;
+	}
+}
+
+template<typename Analysis>
+typename DataFlow<Analysis>::Value DataFlow<Analysis>::before( uint16_t address ) const
+{
+	const uint32_t instruction = graph.instruction_index( address );
+	return ( instruction == BlockGraph::none ) ? analysis.initial() : replay( instruction, false );
+}
+
+template<typename Analysis>
+typename DataFlow<Analysis>::Value DataFlow<Analysis>::after( uint16_t address ) const
+{
+	const uint32_t instruction = graph.instruction_index( address );
+	return ( instruction == BlockGraph::none ) ? analysis.initial() : replay( instruction, true );
+}
@@ -0,0 +1,246 @@
+/*
+ * pass_manager.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "optimiser/pass_manager.h"
+#include "optimiser/passes.h"
+
+#include "ir/opcode_table.h"
+
+#include <algorithm>
+#include <iomanip>
+
+uint16_t Relocation::operator()( uint16_t address ) const
+{
+	for( const auto& [erased, end] : stages ) {
+		uint16_t shift = 0;
+
+		if( address >= end )
+			continue;
+
+		for( const auto& [start, size] : erased ) {
+			if( start >= address )
+				break;
+			shift += size;
+		}
+
+		address -= shift;
+	}
+
+	return address;
+}
+
+static uint16_t element_size( const ASMElement& element )
+{
+	if( const DataElement * data = std::get_if<DataElement>( &element ) )
+		return data->byte_run.size();
+
+	return 2;
+}
+
+static uint16_t element_address( const ASMElement& element )
+{
+	return std::visit( []( const auto& v ) { return v.address; }, element );
+}
+
+FlowFacts::FlowFacts( const IRProgram& ir ) :
+	leader( ir.elements.size() ), after_skip( ir.elements.size() ), pinned( ir.elements.size() )
+{
+	for( size_t i = 0; i < ir.elements.size(); ++i )
+		index.emplace( element_address( ir.elements[i] ), i );
+
+	auto mark_leader = [&]( uint16_t address ) {
+		if( auto it = index.find( address ); it != index.end() )
+			leader[it->second] = true;
+	};
+
+	mark_leader( ir.origin );
+
+	for( size_t i = 0; i < ir.elements.size(); ++i ) {
+
+		const InstructionElement * element = std::get_if<InstructionElement>( &ir.elements[i] );
+
+		if( !element ) {
+			if( i + 1 < ir.elements.size() )
+				leader[i + 1] = true;
+			continue;
+		}
+
+		const OpcodeInfo& info = opcode_info( element->instruction.opcode() );
+		const uint16_t next = element->address + 2;
+
+		if( info.role != AddressRole::None ) {
+			const uint16_t target = std::get<Addr>( element->instruction.operands()[0] ).value;
+
+			if( info.role == AddressRole::ILoadTarget ) {
+				// Up to 16 bytes are read through I; code in that window is data to someone
+				for( size_t j = 0; j < ir.elements.size(); ++j ) {
+					const uint16_t start = element_address( ir.elements[j] );
+					if( start < target + 16 && start + element_size( ir.elements[j] ) > target )
+						pinned[j] = true;
+				}
+			}
+			else
+				mark_leader( target );
+
+			if( info.role == AddressRole::IndexedBase ) {
+				auto it = index.find( target );
+
+				for( size_t j = ( it == index.end() ) ? ir.elements.size() : it->second; j < ir.elements.size(); ++j ) {
+					const InstructionElement * entry = std::get_if<InstructionElement>( &ir.elements[j] );
+
+					pinned[j] = true;
+					leader[j] = true;
+
+					if( !entry || entry->instruction.opcode() != Opcode::JP )
+						break;
+				}
+			}
+		}
+
+		switch( info.successors ) {
+		case Successors::NextOrSkip:
+			if( i + 1 < ir.elements.size() )
+				after_skip[i + 1] = true;
+			mark_leader( next + 2 );
+			break;
+
+		case Successors::NextAndTarget:		// the return lands on the next instruction
+		case Successors::Target:
+		case Successors::None:
+			mark_leader( next );
+			break;
+
+		case Successors::Invalid:
+		case Successors::Next:
+			break;
+		}
+	}
+}
+
+const InstructionElement * FlowFacts::instruction_at( const IRProgram& ir, uint16_t address ) const
+{
+	auto it = index.find( address );
+
+	return ( it == index.end() ) ? nullptr : std::get_if<InstructionElement>( &ir.elements[it->second] );
+}
+
+size_t erase_and_relocate( IRProgram& ir, const std::vector<bool>& erase, Relocation& relocation )
+{
+	Relocation::Erased erased;
+
+	for( size_t i = 0; i < ir.elements.size(); ++i )
+		if( erase[i] )
+			erased.emplace_back( element_address( ir.elements[i] ), element_size( ir.elements[i] ) );
+
+	if( erased.empty() )
+		return 0;
+
+	const uint32_t end = ir.elements.empty() ? 0 : element_address( ir.elements.back() ) + uint32_t( element_size( ir.elements.back() ) );
+
+	Relocation stage;
+	stage.add_stage( erased, end );
+
+	// elements are in address order; a target between or outside them is not part of the program
+	auto inside = [&ir]( uint16_t target ) {
+		auto it = std::upper_bound( ir.elements.begin(), ir.elements.end(), target,
+									[]( uint16_t value, const ASMElement& element ) { return value < element_address( element ); } );
+
+		return it != ir.elements.begin() && target < element_address( *std::prev( it ) ) + uint32_t( element_size( *std::prev( it ) ) );
+	};
+
+	std::vector<ASMElement> kept;
+	kept.reserve( ir.elements.size() - erased.size() );
+
+	for( size_t i = 0; i < ir.elements.size(); ++i ) {
+		if( erase[i] )
+			continue;
+
+		if( InstructionElement * element = std::get_if<InstructionElement>( &ir.elements[i] ) ) {
+			const Instruction& instruction = element->instruction;
+
+			if( opcode_info( instruction.opcode() ).role != AddressRole::None ) {
+				const uint16_t target = std::get<Addr>( instruction.operands()[0] ).value;
+				const uint16_t moved = inside( target ) ? stage( target ) : target;
+				kept.push_back( InstructionElement { stage( element->address ), Instruction::make( instruction.opcode(), Reg { 0 }, Reg { 0 }, 0, Addr { moved } ) } );
+				continue;
+			}
+
+			kept.push_back( InstructionElement { stage( element->address ), instruction } );
+		}
+		else {
+			DataElement data = std::get<DataElement>( ir.elements[i] );
+			data.address = stage( data.address );
+			kept.push_back( std::move( data ) );
+		}
+	}
+
+	ir.elements = std::move( kept );
+
+	size_t bytes = 0;
+	for( const auto& [start, size] : erased )
+		bytes += size;
+
+	relocation.add_stage( std::move( erased ), end );
+
+	return bytes;
+}
+
+PassManager PassManager::standard()
+{
+	PassManager manager;
+
+	manager.add( std::make_unique<RedundantILoadPass>() )
+		   .add( std::make_unique<DeadStorePass>() )
+		   .add( std::make_unique<SkipJumpInversionPass>() )
+		   .add( std::make_unique<JumpThreadingPass>() )
+		   .add( std::make_unique<UnreachableCodePass>() );
+
+	return manager;
+}
+
+std::vector<PassReport> PassManager::run( IRProgram& ir, Relocation& relocation ) const
+{
+	std::stable_sort( ir.elements.begin(), ir.elements.end(),
+					  []( const ASMElement& a, const ASMElement& b ) { return element_address( a ) < element_address( b ); } );
+
+	std::vector<PassReport> reports;
+
+	for( const auto& pass : passes )
+		reports.push_back( pass->run( ir, relocation ) );
+
+	return reports;
+}
+
+void print_reports( std::ostream& os, const std::vector<PassReport>& reports )
+{
+	size_t bytes = 0;
+	size_t cycles = 0;
+
+	for( const PassReport& report : reports ) {
+		os << std::left << std::setw( 24 ) << report.pass << std::right
+		   << std::setw( 6 ) << report.changes << " changes "
+		   << std::setw( 6 ) << report.bytes_saved << " bytes "
+		   << std::setw( 6 ) << report.cycles_saved << " cycles\n";
+
+		bytes += report.bytes_saved;
+		cycles += report.cycles_saved;
+	}
+
+	os << std::left << std::setw( 24 ) << "total" << std::right << std::setw( 21 ) << bytes << " bytes " << std::setw( 6 ) << cycles << " cycles\n";
+}
@@ -0,0 +1,114 @@
+/*
+ * pass_manager.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ir/chip8ir.h"
+
+/*
+	What one pass did. Cycles are counted in instructions that no longer execute on a
+	single trip through the changed code; there is no per-opcode timing model to do better.
+*/
+struct PassReport
+{
+	std::string_view pass;
+	size_t changes = 0;
+	size_t bytes_saved = 0;
+	size_t cycles_saved = 0;
+};
+
+// Maps an address from before the passes ran to where it ended up; composes over every pass that erased code
+class Relocation
+{
+public:
+	using Erased = std::vector<std::pair<uint16_t, uint16_t>>;	// address and size of each erased element, in address order
+
+	// end is one past the last byte of the program the stage erased from; addresses from there on stay put
+	void add_stage( Erased erased, uint32_t end ) { if( !erased.empty() ) stages.push_back( { std::move( erased ), end } ); }
+
+	uint16_t operator()( uint16_t address ) const;
+
+private:
+	struct Stage {
+		Erased erased;
+		uint32_t end;
+	};
+
+	std::vector<Stage> stages;
+};
+
+/*
+	What a pass must know about each element before it may remove or rewrite it. The
+	elements are taken in address order, the pass manager sorts them before the first pass.
+*/
+struct FlowFacts
+{
+	explicit FlowFacts( const IRProgram& ir );
+
+	std::vector<bool> leader;			// control can arrive here other than by falling through
+	std::vector<bool> after_skip;		// the instruction before may skip this one
+	std::vector<bool> pinned;			// in a JP V0 table or read through I; never removed or rewritten
+	std::unordered_map<uint16_t, size_t> index;	// element by address
+
+	const InstructionElement * instruction_at( const IRProgram& ir, uint16_t address ) const;
+};
+
+/*
+	Removes the marked elements, moves everything after them down and points every
+	address operand into the program at where its target went. Operands outside every
+	element, such as scratch RAM past the image, keep their value. Returns the bytes removed.
+*/
+size_t erase_and_relocate( IRProgram& ir, const std::vector<bool>& erase, Relocation& relocation );
+
+class IRPass
+{
+public:
+	virtual ~IRPass() = default;
+
+	virtual std::string_view name() const = 0;
+	virtual PassReport run( IRProgram& ir, Relocation& relocation ) = 0;
+};
+
+class PassManager
+{
+public:
+	PassManager() = default;
+
+	// Redundant LD I, dead stores, skip over JP, jump threading, unreachable code; in that order
+	static PassManager standard();
+
+	PassManager& add( std::unique_ptr<IRPass> pass ) { passes.push_back( std::move( pass ) ); return *this; }
+
+	std::vector<PassReport> run( IRProgram& ir, Relocation& relocation ) const;
+	std::vector<PassReport> run( IRProgram& ir ) const { Relocation relocation; return run( ir, relocation ); }
+
+private:
+	std::vector<std::unique_ptr<IRPass>> passes;
+};
+
+void print_reports( std::ostream& os, const std::vector<PassReport>& reports );
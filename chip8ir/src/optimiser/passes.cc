@@ -0,0 +1,296 @@
+/*
+ * passes.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "optimiser/passes.h"
+
+#include "ir/opcode_table.h"
+
+#include <optional>
+#include <stack>
+
+static bool ends_straight_line( Opcode opcode )
+{
+	const Successors successors = opcode_info( opcode ).successors;
+	return successors != Successors::Next && successors != Successors::NextOrSkip;
+}
+
+PassReport RedundantILoadPass::run( IRProgram& ir, Relocation& relocation )
+{
+	const FlowFacts facts( ir );
+	std::vector<bool> erase( ir.elements.size() );
+	std::optional<uint16_t> known;
+	PassReport report { name() };
+
+	for( size_t i = 0; i < ir.elements.size(); ++i ) {
+
+		const InstructionElement * element = std::get_if<InstructionElement>( &ir.elements[i] );
+
+		if( !element || facts.leader[i] ) {
+			known.reset();
+			if( !element )
+				continue;
+		}
+
+		const Instruction& instruction = element->instruction;
+
+		switch( instruction.opcode() ) {
+		case Opcode::LD_I:
+			{
+				const uint16_t target = std::get<Addr>( instruction.operands()[0] ).value;
+
+				if( facts.after_skip[i] )				// may not run, so I is one of two values after it
+					known.reset();
+				else if( known == target && !facts.pinned[i] ) {
+					erase[i] = true;
+					++report.changes;
+					++report.cycles_saved;
+				}
+				else
+					known = target;
+			}
+			break;
+
+		case Opcode::ADD_I:
+		case Opcode::LD_SPRITE:
+		case Opcode::ST_REGS:		// the original interpreter leaves I past the last register
+		case Opcode::LD_REGS:
+			known.reset();
+			break;
+
+		default:
+			if( ends_straight_line( instruction.opcode() ) )
+				known.reset();
+			break;
+		}
+	}
+
+	report.bytes_saved = erase_and_relocate( ir, erase, relocation );
+	return report;
+}
+
+/*
+	Follows the straight line after a store. The store is dead when an instruction that
+	certainly runs overwrites the register before anything reads it; any branch ends
+	the search with the register considered live.
+*/
+PassReport DeadStorePass::run( IRProgram& ir, Relocation& relocation )
+{
+	const FlowFacts facts( ir );
+	std::vector<bool> erase( ir.elements.size() );
+	PassReport report { name() };
+
+	for( size_t i = 0; i < ir.elements.size(); ++i ) {
+
+		const InstructionElement * element = std::get_if<InstructionElement>( &ir.elements[i] );
+
+		if( !element || facts.after_skip[i] || facts.pinned[i] )
+			continue;
+
+		switch( element->instruction.opcode() ) {
+		case Opcode::LD_Imm:
+		case Opcode::LD_Reg:
+		case Opcode::ADD_Imm:
+		case Opcode::RND:
+		case Opcode::ST_DT:
+			break;
+		default:
+			continue;
+		}
+
+		const uint16_t stored = register_use( element->instruction ).writes;
+
+		for( size_t j = i + 1; j < ir.elements.size(); ++j ) {
+
+			const InstructionElement * later = std::get_if<InstructionElement>( &ir.elements[j] );
+			if( !later || erase[j] )
+				break;
+
+			const RegisterUse use = register_use( later->instruction );
+
+			if( use.reads & stored )
+				break;
+
+			if( ( use.writes & stored ) && !facts.after_skip[j] ) {
+				erase[i] = true;
+				++report.changes;
+				++report.cycles_saved;
+				break;
+			}
+
+			if( ends_straight_line( later->instruction.opcode() ) )
+				break;
+		}
+	}
+
+	report.bytes_saved = erase_and_relocate( ir, erase, relocation );
+	return report;
+}
+
+static std::optional<Opcode> inverted( Opcode opcode )
+{
+	switch( opcode ) {
+	case Opcode::SE_Imm:  return Opcode::SNE_Imm;
+	case Opcode::SNE_Imm: return Opcode::SE_Imm;
+	case Opcode::SE_Reg:  return Opcode::SNE_Reg;
+	case Opcode::SNE_Reg: return Opcode::SE_Reg;
+	case Opcode::SKP:     return Opcode::SKNP;
+	case Opcode::SKNP:    return Opcode::SKP;
+	default:              return std::nullopt;
+	}
+}
+
+PassReport SkipJumpInversionPass::run( IRProgram& ir, Relocation& relocation )
+{
+	const FlowFacts facts( ir );
+	std::vector<bool> erase( ir.elements.size() );
+	PassReport report { name() };
+
+	for( size_t i = 0; i + 2 < ir.elements.size(); ++i ) {
+
+		auto * skip = std::get_if<InstructionElement>( &ir.elements[i] );
+		auto * jump = std::get_if<InstructionElement>( &ir.elements[i + 1] );
+		auto * over = std::get_if<InstructionElement>( &ir.elements[i + 2] );
+
+		if( !skip || !jump || !over || erase[i] )
+			continue;
+
+		const std::optional<Opcode> opposite = inverted( skip->instruction.opcode() );
+
+		if( !opposite || jump->instruction.opcode() != Opcode::JP || jump->address != skip->address + 2 || over->address != jump->address + 2 )
+			continue;
+
+		// Nothing else may land on the JP, it is about to disappear
+		if( facts.leader[i + 1] || facts.pinned[i] || facts.pinned[i + 1] || facts.pinned[i + 2] )
+			continue;
+
+		if( std::get<Addr>( jump->instruction.operands()[0] ).value != over->address + 2 )
+			continue;
+
+		const Instruction& instruction = skip->instruction;
+		const Reg x = std::get<Reg>( instruction.operands()[0] );
+		const Reg y = ( instruction.operands().size() > 1 && std::holds_alternative<Reg>( instruction.operands()[1] ) ) ? std::get<Reg>( instruction.operands()[1] ) : Reg { 0 };
+		const uint8_t imm = ( instruction.operands().size() > 1 && std::holds_alternative<Imm>( instruction.operands()[1] ) ) ? std::get<Imm>( instruction.operands()[1] ).value : 0;
+
+		skip->instruction = Instruction::make( *opposite, x, y, imm, Addr { 0 } );
+		erase[i + 1] = true;
+		++report.changes;
+		++report.cycles_saved;
+		++i;
+	}
+
+	report.bytes_saved = erase_and_relocate( ir, erase, relocation );
+	return report;
+}
+
+PassReport JumpThreadingPass::run( IRProgram& ir, Relocation& )
+{
+	const FlowFacts facts( ir );
+	PassReport report { name() };
+
+	for( size_t i = 0; i < ir.elements.size(); ++i ) {
+
+		auto * element = std::get_if<InstructionElement>( &ir.elements[i] );
+
+		if( !element || facts.pinned[i] )
+			continue;
+
+		const Opcode opcode = element->instruction.opcode();
+		if( opcode != Opcode::JP && opcode != Opcode::CALL )
+			continue;
+
+		const uint16_t first = std::get<Addr>( element->instruction.operands()[0] ).value;
+		uint16_t target = first;
+		size_t hops = 0;
+
+		// A short chain, so a loop of jumps cannot hold us up
+		while( hops < 16 ) {
+			const InstructionElement * next = facts.instruction_at( ir, target );
+
+			if( !next || next->instruction.opcode() != Opcode::JP || next->address == element->address )
+				break;
+
+			const uint16_t onward = std::get<Addr>( next->instruction.operands()[0] ).value;
+			if( onward == target )
+				break;
+
+			target = onward;
+			++hops;
+		}
+
+		if( target != first ) {
+			element->instruction = Instruction::make( opcode, Reg { 0 }, Reg { 0 }, 0, Addr { target } );
+			++report.changes;
+			report.cycles_saved += hops;
+		}
+	}
+
+	return report;
+}
+
+PassReport UnreachableCodePass::run( IRProgram& ir, Relocation& relocation )
+{
+	const FlowFacts facts( ir );
+	std::vector<bool> reached( ir.elements.size() );
+	std::stack<uint16_t> pending;
+	PassReport report { name() };
+
+	for( const ASMElement& element : ir.elements )
+		if( auto * instruction = std::get_if<InstructionElement>( &element ); instruction && instruction->instruction.opcode() == Opcode::JP_V0 )
+			return report;
+
+	pending.push( ir.origin );
+
+	while( !pending.empty() ) {
+		const uint16_t address = pending.top();
+		pending.pop();
+
+		auto it = facts.index.find( address );
+		if( it == facts.index.end() || reached[it->second] )
+			continue;
+
+		reached[it->second] = true;
+
+		const auto * element = std::get_if<InstructionElement>( &ir.elements[it->second] );
+		if( !element )
+			continue;
+
+		const OpcodeInfo& info = opcode_info( element->instruction.opcode() );
+		const uint16_t next = address + 2;
+
+		switch( info.successors ) {
+		case Successors::Invalid:
+		case Successors::Next:          pending.push( next ); break;
+		case Successors::NextOrSkip:    pending.push( next ); pending.push( next + 2 ); break;
+		case Successors::Target:        pending.push( std::get<Addr>( element->instruction.operands()[0] ).value ); break;
+		case Successors::NextAndTarget: pending.push( next ); pending.push( std::get<Addr>( element->instruction.operands()[0] ).value ); break;
+		case Successors::None:          break;
+		}
+	}
+
+	std::vector<bool> erase( ir.elements.size() );
+
+	for( size_t i = 0; i < ir.elements.size(); ++i )
+		if( !reached[i] && !facts.pinned[i] && std::holds_alternative<InstructionElement>( ir.elements[i] ) ) {
+			erase[i] = true;
+			++report.changes;
+		}
+
+	report.bytes_saved = erase_and_relocate( ir, erase, relocation );
+	return report;
+}
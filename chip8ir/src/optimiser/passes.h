@@ -0,0 +1,63 @@
+/*
+ * passes.h Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include "optimiser/dataflow.h"
+#include "optimiser/pass_manager.h"
+
+// LD I with the value I already holds in the same block
+class RedundantILoadPass : public IRPass
+{
+public:
+	std::string_view name() const override { return "redundant-ld-i"; }
+	PassReport run( IRProgram& ir, Relocation& relocation ) override;
+};
+
+// A register load whose value is overwritten on the straight line after it before anything reads it
+class DeadStorePass : public IRPass
+{
+public:
+	std::string_view name() const override { return "dead-store"; }
+	PassReport run( IRProgram& ir, Relocation& relocation ) override;
+};
+
+// SE ..; JP L; X; L: becomes SNE ..; X; L:
+class SkipJumpInversionPass : public IRPass
+{
+public:
+	std::string_view name() const override { return "skip-jump-inversion"; }
+	PassReport run( IRProgram& ir, Relocation& relocation ) override;
+};
+
+// JP and CALL aimed at a JP go straight to its final target
+class JumpThreadingPass : public IRPass
+{
+public:
+	std::string_view name() const override { return "jump-threading"; }
+	PassReport run( IRProgram& ir, Relocation& relocation ) override;
+};
+
+// Instructions no path from the entry point reaches; skipped when the program has a JP V0
+class UnreachableCodePass : public IRPass
+{
+public:
+	std::string_view name() const override { return "unreachable-code"; }
+	PassReport run( IRProgram& ir, Relocation& relocation ) override;
+};
@@ -18,6 +18,10 @@
  */
 
 #include <gtest/gtest.h>
+
+#include <algorithm>
+#include <variant>
+
 #include "disassembler/disassembler.h"
 
 class IntegrationTest : public ::testing::Test
@@ -60,6 +64,24 @@ TEST_F(IntegrationTest, straight_line_with_data)
     EXPECT_EQ(d->byte_run.size(), 4);
 }
 
+TEST_F(IntegrationTest, data_runs_slice_the_source_image)
+{
+    auto bin = std::make_shared<const BinImage>( BinImage {
+        0x12, 0x00,     // JP 0x200
+        0xF0, 0x90, 0xF0,
+    } );
+
+    auto [ir, symbols] = dis.build_ir(bin);
+
+    ASSERT_EQ(ir.elements.size(), 2);
+
+    auto* d = std::get_if<DataElement>(&ir.elements[1]);
+    ASSERT_NE(d, nullptr);
+    EXPECT_EQ(d->address, 0x202);
+    ASSERT_EQ(d->byte_run.size(), 3);
+    EXPECT_EQ(d->byte_run.data(), bin->data() + 2);
+}
+
 TEST_F(IntegrationTest, conditional_skip)
 {
     BinImage bin = {
@@ -155,3 +177,71 @@ TEST_F(IntegrationTest, invalid_opcode_terminates_code_path)
     EXPECT_TRUE(std::holds_alternative<InstructionElement>(ir.elements[1]));
     EXPECT_TRUE(std::holds_alternative<DataElement>(ir.elements[2]));
 }
+
+TEST_F(IntegrationTest, jump_table_entries_follow_v0)
+{
+    BinImage bin = {
+        0xC0, 0x06,     // 0x200 RND V0, 0x06       V0 is 0, 2, 4 or 6
+        0xB2, 0x06,     // 0x202 JP V0, 0x206
+        0x00, 0x00,
+        0x12, 0x10,     // 0x206 table
+        0x12, 0x10,
+        0x12, 0x10,
+        0x12, 0x10,
+        0xAA, 0xBB,     // 0x20E past the end of the table
+        0x12, 0x10,     // 0x210 JP 0x210
+    };
+
+    auto [ir, symbols] = dis.build_ir(bin);
+
+    ASSERT_EQ(ir.elements.size(), 9);
+
+    auto* d = std::get_if<DataElement>(&ir.elements[7]);
+    ASSERT_NE(d, nullptr);
+    EXPECT_EQ(d->address, 0x20E);
+    EXPECT_EQ(d->byte_run.size(), 2);
+}
+
+TEST_F(IntegrationTest, jump_table_base_is_data_when_v0_cannot_be_zero)
+{
+    BinImage bin = {
+        0x60, 0x02,     // 0x200 LD V0, 2
+        0xB2, 0x06,     // 0x202 JP V0, 0x206
+        0x00, 0x00,
+        0x00, 0xE0,     // 0x206 table base, never reached
+        0x12, 0x08,     // 0x208 JP 0x208
+    };
+
+    auto [ir, symbols] = dis.build_ir(bin);
+
+    auto at = [&ir]( uint16_t address ) {
+        return std::find_if( ir.elements.begin(), ir.elements.end(),
+                             [address]( const ASMElement& element ) { return std::visit( []( auto& e ) { return e.address; }, element ) == address; } );
+    };
+
+    ASSERT_NE(at(0x206), ir.elements.end());
+    EXPECT_TRUE(std::holds_alternative<DataElement>(*at(0x206)));
+
+    ASSERT_NE(at(0x208), ir.elements.end());
+    EXPECT_TRUE(std::holds_alternative<InstructionElement>(*at(0x208)));
+}
+
+TEST_F(IntegrationTest, jump_table_with_unknown_v0_is_walked_to_the_next_label)
+{
+    BinImage bin = {
+        0xF0, 0x07,     // 0x200 LD V0, DT
+        0xB2, 0x06,     // 0x202 JP V0, 0x206
+        0x00, 0x00,
+        0x12, 0x0A,     // 0x206 table
+        0x12, 0x0A,
+        0x12, 0x0A,     // 0x20A JP 0x20A
+    };
+
+    auto [ir, symbols] = dis.build_ir(bin);
+
+    ASSERT_EQ(ir.elements.size(), 6);
+
+    auto* i = std::get_if<InstructionElement>(&ir.elements[4]);
+    ASSERT_NE(i, nullptr);
+    EXPECT_EQ(i->address, 0x208);
+}
@@ -19,6 +19,8 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
+
 #include "ir/chip8ir.h"
 #include "disassembler/symbol_table.h"
 
@@ -100,6 +102,25 @@ TEST_F(SymbolsTest, indexed_list_contents)
     EXPECT_EQ(list[1], 0x300);
 }
 
+TEST_F(SymbolsTest, every_label_is_visited_once_with_its_name)
+{
+    symbols.add(DecodedSymbol{0x300, JUMP});
+    symbols.add(DecodedSymbol{0x200, JUMP});
+    symbols.add(DecodedSymbol{0x300, I_TARGET});
+    symbols.add(DecodedSymbol{0x400, SUBROUTINE});
+
+    symbols.sort_vectors();
+
+    std::map<uint16_t, std::string> visited;
+    symbols.for_each_label( [&]( uint16_t address, std::string_view label ) {
+        EXPECT_TRUE( visited.emplace( address, label ).second );
+    } );
+
+    ASSERT_EQ(visited.size(), 3);
+    for( const auto& [address, label] : visited )
+        EXPECT_EQ(label, symbols.get_label(address));
+}
+
 // #ifndef NDEBUG
 // TEST_F(SymbolsTest, get_label_without_sort_asserts)
 // {
@@ -0,0 +1,129 @@
+/*
+ * stack_analysis_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include "disassembler/disassembler.h"
+#include "emulator/stack_analysis.h"
+
+class StackAnalysisTest : public ::testing::Test
+{
+protected:
+    Disassembler dis;
+
+    void SetUp() override {
+        dis.configure({0x200});
+    }
+
+    StackProof prove( const BinImage& bin ) {
+        return prove_stack_depth( dis.build_ir( bin ).ir );
+    }
+};
+
+TEST_F(StackAnalysisTest, no_calls_needs_no_stack)
+{
+    StackProof proof = prove( {
+        0x60, 0x01,     // 0x200 LD V0, 1
+        0x12, 0x00,     // 0x202 JP 0x200
+    } );
+
+    EXPECT_TRUE( proof.proven );
+    EXPECT_EQ( proof.max_depth, 0u );
+}
+
+TEST_F(StackAnalysisTest, deepest_call_chain_counts)
+{
+    StackProof proof = prove( {
+        0x22, 0x0A,     // 0x200 CALL 0x20A
+        0x22, 0x0C,     // 0x202 CALL 0x20C
+        0x30, 0x00,     // 0x204 SE V0, 0
+        0x22, 0x10,     // 0x206 CALL 0x210    only reached through the skip
+        0x12, 0x00,     // 0x208 JP 0x200
+        0x00, 0xEE,     // 0x20A RET
+        0x22, 0x10,     // 0x20C CALL 0x210
+        0x00, 0xEE,     // 0x20E RET
+        0x22, 0x0A,     // 0x210 CALL 0x20A
+        0x00, 0xEE,     // 0x212 RET
+    } );
+
+    EXPECT_TRUE( proof.proven );
+    EXPECT_EQ( proof.max_depth, 3u );
+}
+
+TEST_F(StackAnalysisTest, recursion_is_flagged)
+{
+    StackProof proof = prove( {
+        0x22, 0x04,     // 0x200 CALL 0x204
+        0x12, 0x02,     // 0x202 JP 0x202
+        0x30, 0x00,     // 0x204 SE V0, 0
+        0x22, 0x04,     // 0x206 CALL 0x204
+        0x00, 0xEE,     // 0x208 RET
+    } );
+
+    EXPECT_FALSE( proof.proven );
+    EXPECT_EQ( proof.recursive_calls, std::vector<uint16_t>{ 0x206 } );
+}
+
+TEST_F(StackAnalysisTest, indexed_jump_is_not_proven)
+{
+    StackProof proof = prove( {
+        0xB2, 0x04,     // 0x200 JP V0, 0x204
+        0x12, 0x02,     // 0x202 JP 0x202
+        0x12, 0x02,     // 0x204 JP 0x202
+    } );
+
+    EXPECT_FALSE( proof.proven );
+    EXPECT_EQ( proof.unresolved_flow, std::vector<uint16_t>{ 0x200 } );
+}
+
+TEST_F(StackAnalysisTest, sys_is_not_proven)
+{
+    StackProof proof = prove( {
+        0x60, 0x01,     // 0x200 LD V0, 1
+        0x02, 0x08,     // 0x202 SYS 0x208
+        0x12, 0x04,     // 0x204 JP 0x204
+    } );
+
+    EXPECT_FALSE( proof.proven );
+    EXPECT_EQ( proof.unresolved_flow, std::vector<uint16_t>{ 0x202 } );
+
+    // A NOP element in IR from other sources is the word 0000, SYS 0x000
+    IRProgram ir;
+    ir.origin = 0x200;
+    ir.elements = {
+        InstructionElement { 0x200, Instruction::make_nop() },
+        InstructionElement { 0x202, Instruction::make_jump( Addr { 0x202 } ) },
+    };
+
+    proof = prove_stack_depth( ir );
+
+    EXPECT_FALSE( proof.proven );
+    EXPECT_EQ( proof.unresolved_flow, std::vector<uint16_t>{ 0x200 } );
+}
+
+TEST_F(StackAnalysisTest, return_from_entry_underflows)
+{
+    StackProof proof = prove( {
+        0x60, 0x01,     // 0x200 LD V0, 1
+        0x00, 0xEE,     // 0x202 RET
+    } );
+
+    EXPECT_FALSE( proof.proven );
+    EXPECT_EQ( proof.entry_returns, std::vector<uint16_t>{ 0x202 } );
+}
@@ -20,6 +20,7 @@
 
 #include "ir/asm_emitter.h"
 #include <map>
+#include <sstream>
 
 class ASMEmitterTestResolver : public ILabelResolver
 {
@@ -151,3 +152,39 @@ TEST(ASMEmitterTest, all_opcodes_visual_inspection)
     emitter_clean.emit(std::cout, bundle, image, ASMEmitter::OutputMode::Assembly);
     std::cout << "=============================\n";
 }
+
+TEST(ASMEmitterTest, listing_columns_are_zero_padded)
+{
+	BinImage image { 0x6B, 0x0C, 0x13, 0x00, 0xD0, 0x15, 0x05, 0x41, 0x00 };
+
+	IRProgram ir;
+	ASMEmitterTestResolver resolver;
+
+	ir.elements.push_back( InstructionElement{ 0x200, Instruction::make_ld( Reg {0xB}, Imm {0x0C} ) } );
+	ir.elements.push_back( InstructionElement{ 0x202, Instruction::make_jump( Addr {0x300} ) } );
+	ir.elements.push_back( InstructionElement{ 0x204, Instruction::make_drw( Reg {0}, Reg {1}, Nibble {5} ) } );
+	ir.elements.push_back( DataElement{ 0x206, { 0x05, 0x41, 0x00 } } );
+
+	resolver.add( 0x202, "LABEL0" );
+	resolver.add( 0x206, "DATA0" );
+
+	IRBundle bundle { ir, std::make_unique<ASMEmitterTestResolver>(resolver) };
+
+	ASMEmitter emitter;
+	emitter.configure( { "test" } );
+
+	std::ostringstream os;
+	emitter.emit( os, bundle, image, ASMEmitter::OutputMode::Listing );
+
+	EXPECT_EQ( os.str(),
+		"; Disasembly of test\n"
+		"; Generated by chidisas8\n"
+		";\n"
+		"\n"
+		"\t.ORG 0x200  \n"
+		"\n"
+		"0x200  6B 0C          LD VB, #0C\n"
+		"0x202  13 00  LABEL0: JP 0x300\n"
+		"0x204  D0 15          DRW V0, V1, 0x5\n"
+		"0x206  DATA0:  .DB 0x05, 0x41, 0x00 ; .A.\n" );
+}
@@ -294,3 +294,22 @@ TEST_F(Chip8IRTest, InstructionEqualityAndStream)
         EXPECT_NE(out.find(mnemonic), std::string::npos) << "Mnemonic \"" << mnemonic << "\" not found in stream: " << out;
     }
 }
+
+TEST_F(Chip8IRTest, ArenaRunsOutliveGrowth)
+{
+    ByteArena arena;
+
+    const uint8_t first[] = { 1, 2, 3 };
+    ByteRun a = arena.append( first );
+
+    std::vector<uint8_t> many( 1000, 7 );
+    ByteRun b = arena.append( many );		// reallocates the storage under a
+
+    ASSERT_EQ(a.size(), 3);
+    EXPECT_EQ(a[0], 1);
+    EXPECT_EQ(a[2], 3);
+    EXPECT_EQ(b.size(), 1000);
+    EXPECT_EQ(b[999], 7);
+
+    EXPECT_EQ(( DataElement { 0x300, a } ), ( DataElement { 0x300, { 1, 2, 3 } } ));
+}
@@ -0,0 +1,87 @@
+/*
+ * compact_ir_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ir/compact_ir.h"
+#include "ir/decoder.h"
+
+class CompactIRTest : public ::testing::Test
+{
+protected:
+    IRProgram ir;
+
+    void SetUp() override
+    {
+        ir.elements.push_back( InstructionElement { 0x200, Instruction::make_ld_i( Addr { 0x20A } ) } );
+        ir.elements.push_back( InstructionElement { 0x202, Instruction::make_drw( Reg { 1 }, Reg { 2 }, Nibble { 5 } ) } );
+        ir.elements.push_back( InstructionElement { 0x204, Instruction::make_skip_eq( Reg { 3 }, Imm { 0xAA } ) } );
+        ir.elements.push_back( InstructionElement { 0x206, Instruction::make_jump( Addr { 0x200 } ) } );
+        ir.elements.push_back( InstructionElement { 0x208, Instruction::make_return() } );
+        ir.elements.push_back( DataElement { 0x20A, { 0xF0, 0x90, 0xF0 } } );
+        ir.elements.push_back( DataElement { 0x20D, { 0x11 } } );
+    }
+};
+
+TEST_F(CompactIRTest, accessors_return_the_typed_operands)
+{
+    const PackedInstruction drw( 0x202, Instruction::make_drw( Reg { 1 }, Reg { 2 }, Nibble { 5 } ) );
+
+    EXPECT_EQ( drw.location(), 0x202 );
+    EXPECT_EQ( drw.opcode(), Opcode::DRW );
+    EXPECT_EQ( drw.x(), Reg { 1 } );
+    EXPECT_EQ( drw.y(), Reg { 2 } );
+    EXPECT_EQ( drw.nibble(), Nibble { 5 } );
+
+    const PackedInstruction call( 0x300, Instruction::make_call( Addr { 0xABC } ) );
+    EXPECT_EQ( call.target(), Addr { 0xABC } );
+    EXPECT_EQ( call.x(), Reg { 0 } );
+}
+
+TEST_F(CompactIRTest, every_decodable_opcode_survives_packing)
+{
+    Decoder decoder;
+
+    for( uint32_t word = 0; word <= 0xFFFF; ++word ) {
+        const Instruction instruction = decoder.decode( 0x200, uint16_t( word ) ).instruction;
+
+        EXPECT_EQ( PackedInstruction( 0x200, instruction ).expand(), instruction ) << std::hex << word;
+    }
+}
+
+TEST_F(CompactIRTest, splits_and_merges_by_address)
+{
+    std::swap( ir.elements[1], ir.elements[5] );		// the split sorts, the merge restores address order
+
+    const CompactProgram program = compact( ir );
+
+    ASSERT_EQ( program.instructions.size(), 5u );
+    ASSERT_EQ( program.data.size(), 2u );
+    EXPECT_EQ( program.data_bytes.size(), 4u );
+
+    EXPECT_EQ( program.instructions[1].location(), 0x202 );
+    EXPECT_EQ( program.bytes( program.data[1] )[0], 0x11 );
+
+    ASSERT_NE( program.find_instruction( 0x206 ), nullptr );
+    EXPECT_EQ( program.find_instruction( 0x206 )->opcode(), Opcode::JP );
+    EXPECT_EQ( program.find_instruction( 0x207 ), nullptr );
+
+    std::swap( ir.elements[1], ir.elements[5] );
+    EXPECT_EQ( expand( program ), ir );
+}
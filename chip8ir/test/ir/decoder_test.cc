@@ -20,6 +20,7 @@
 #include <gtest/gtest.h>
 
 #include "ir/decoder.h"
+#include "ir/encoder.h"
 
 class DecoderTest : public ::testing::Test
 {
@@ -269,3 +270,28 @@ TEST_F(DecoderTest, control_flow_invalid_opcode)
 
     EXPECT_EQ(r.role, AddressRole::None );
 }
+
+TEST_F(DecoderTest, every_valid_opcode_encodes_back_to_itself)
+{
+    BinaryEncoder encoder;
+    size_t valid = 0;
+
+    for( uint32_t word = 0; word <= 0xFFFF; ++word ) {
+        auto r = decoder.decode(0x200, uint16_t(word));
+
+        EXPECT_EQ(r.valid, Decoder::lookup(uint16_t(word)).successors != Successors::Invalid);
+        if( !r.valid )
+            continue;
+
+        ++valid;
+
+        IRProgram program;
+        program.elements.push_back( InstructionElement { 0x200, r.instruction } );
+
+        const BinImage image = encoder.encode( program );
+        ASSERT_EQ(image.size(), 2u);
+        EXPECT_EQ(uint16_t((image[0] << 8) | image[1]), word) << std::hex << word;
+    }
+
+    EXPECT_GT(valid, 40000u);
+}
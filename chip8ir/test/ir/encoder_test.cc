@@ -91,6 +91,7 @@ TEST_F(EncoderTest, Encodes_DRW)
 
 TEST_F(EncoderTest, Encodes_DataElement)
 {
+    ir.origin = 0x300;
     ir.elements.push_back( DataElement { 0x300, { 0xDE, 0xAD, 0xBE, 0xEF } } );
 
     auto image = encoder.encode(ir);
@@ -131,16 +132,63 @@ TEST_F(EncoderTest, Encodes_MaxValues)
     EXPECT_EQ(make_word(image), 0x3FFF);
 }
 
-TEST_F(EncoderTest, IgnoresElementAddresses)
+TEST_F(EncoderTest, PlacesElementsAtTheirAddresses)
 {
-    ir.elements.push_back( InstructionElement{ 0x400, Instruction::make_clear() } );
-    ir.elements.push_back( InstructionElement{ 0x100, Instruction::make_return() } );
+    ir.elements.push_back( InstructionElement{ 0x206, Instruction::make_clear() } );
+    ir.elements.push_back( InstructionElement{ 0x200, Instruction::make_return() } );
+    ir.elements.push_back( DataElement{ 0x203, { 0xAA } } );
 
     auto image = encoder.encode(ir);
 
-    ASSERT_EQ(image.size(), 4);
-    EXPECT_EQ(make_word(image, 0), 0x00E0);
-    EXPECT_EQ(make_word(image, 2), 0x00EE);
+    ASSERT_EQ(image.size(), 8);
+    EXPECT_EQ(make_word(image, 0), 0x00EE);
+    EXPECT_EQ(make_word(image, 2), 0x00AA);
+    EXPECT_EQ(make_word(image, 4), 0x0000);
+    EXPECT_EQ(make_word(image, 6), 0x00E0);
+}
+
+TEST_F(EncoderTest, FillsGapsWithConfiguredByte)
+{
+    encoder.configure( { 0xFF } );
+
+    ir.elements.push_back( InstructionElement{ 0x200, Instruction::make_clear() } );
+    ir.elements.push_back( InstructionElement{ 0x204, Instruction::make_return() } );     // .ORG 0x204
+
+    auto image = encoder.encode(ir);
+
+    ASSERT_EQ(image.size(), 6);
+    EXPECT_EQ(make_word(image, 2), 0xFFFF);
+    EXPECT_EQ(make_word(image, 4), 0x00EE);
+}
+
+TEST_F(EncoderTest, RejectsOverlapsAndElementsBelowOrigin)
+{
+    ir.elements.push_back( InstructionElement{ 0x200, Instruction::make_clear() } );
+    ir.elements.push_back( DataElement{ 0x201, { 0xAA } } );
+
+    EXPECT_THROW( encoder.encode(ir), std::runtime_error );
+
+    ir.elements.pop_back();
+    ir.elements.push_back( InstructionElement{ 0x100, Instruction::make_return() } );
+
+    EXPECT_THROW( encoder.encode(ir), std::runtime_error );
+}
+
+TEST_F(EncoderTest, EncodesIntoCallerBuffer)
+{
+    ir.elements.push_back( InstructionElement{ 0x202, Instruction::make_jump( Addr { 0x234 }) } );
+
+    ASSERT_EQ( encoder.image_size(ir), 4 );
+
+    BinImage buffer( 6, 0x55 );
+    encoder.encode_into( ir, buffer );
+
+    EXPECT_EQ(make_word(buffer, 0), 0x0000);
+    EXPECT_EQ(make_word(buffer, 2), 0x1234);
+    EXPECT_EQ(make_word(buffer, 4), 0x0000);
+
+    BinImage small( 3 );
+    EXPECT_THROW( encoder.encode_into( ir, small ), std::runtime_error );
 }
 
 TEST_F(EncoderTest, Encodes_SKP)
@@ -25,7 +25,15 @@
 #include "ir/encoder.h"
 #include "ir/decoder.h"
 
+#include "ir/asm_emitter.h"
+#include "ir/ir_cache.h"
+#include "ir/opcode_table.h"
+
 #include "disassembler/disassembler.h"
+#include "assembler/assembler.h"
+#include "assembler/loader.h"
+
+#include <sstream>
 
 class IntegrationTest : public ::testing::Test
 {
@@ -97,4 +105,25 @@ TEST_F(IntegrationTest, EncoderDecoderRoundtripMultiStatement)
 	auto reconstructed = dis.build_ir( image );
 
 	EXPECT_EQ( reconstructed.ir, ir );
-}
\ No newline at end of file
+}
+
+TEST_F(IntegrationTest, EmittedAssemblyAssemblesBack)
+{
+	IRProgram ir;
+	uint16_t address = 0x200;
+
+	for( const OpcodeInfo& info : opcode_table ) {
+		ir.elements.push_back( InstructionElement{ address, Instruction::make( info.opcode, Reg{3}, Reg{0xA}, 0x07, Addr{0x300} ) } );
+		address += 2;
+	}
+
+	IRBundle bundle { ir, std::make_unique<LabelTable>() };
+
+	std::ostringstream os;
+	ASMEmitter().emit( os, bundle, {}, ASMEmitter::OutputMode::Assembly );
+
+	std::istringstream is( os.str() );
+	IRBundle assembled = Assembler().build_ir( load_assembly_source( is ) );
+
+	EXPECT_EQ( assembled.ir, ir ) << os.str();
+}
@@ -0,0 +1,155 @@
+/*
+ * ir_cache_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include <unistd.h>
+
+#include "ir/ir_cache.h"
+#include "disassembler/disassembler.h"
+
+class IRCacheTest : public ::testing::Test
+{
+protected:
+    const BinImage image = {
+        0xA2, 0x08,     // 0x200 LD I, 0x208
+        0xD0, 0x13,     // 0x202 DRW V0, V1, 3
+        0x22, 0x0B,     // 0x204 CALL 0x20B
+        0x12, 0x00,     // 0x206 JP 0x200
+        0xF0, 0x90, 0xF0,
+        0x00, 0xEE      // 0x20B RET
+    };
+
+    Disassembler dis;
+    std::filesystem::path directory;
+
+    void SetUp() override
+    {
+        dis.configure( { 0x200 } );
+        directory = std::filesystem::temp_directory_path() / ( "ir_cache_test." + std::to_string( ::getpid() ) );
+    }
+
+    void TearDown() override { std::filesystem::remove_all( directory ); }
+};
+
+TEST_F(IRCacheTest, bundle_survives_a_round_trip)
+{
+    const IRBundle bundle = dis.build_ir( image );
+
+    auto bytes = std::make_shared<const std::vector<uint8_t>>( serialise_bundle( bundle ) );
+    const IRBundle loaded = deserialise_bundle( bytes );
+
+    EXPECT_EQ( loaded.ir, bundle.ir );
+
+    for( uint16_t address = 0x200; address < 0x20D; ++address )
+        EXPECT_EQ( loaded.resolver->get_label( address ), bundle.resolver->get_label( address ) ) << std::hex << address;
+
+    EXPECT_FALSE( loaded.resolver->get_label( 0x20B ).empty() );
+}
+
+TEST_F(IRCacheTest, labels_past_4k_are_stored_in_address_order)
+{
+    auto labels = std::make_unique<LabelTable>();
+    labels->add( 0x2400, "FAR" );
+    labels->add( 0x0200, "START" );
+    labels->add( 0x0FFE, "EDGE" );
+
+    IRBundle bundle { dis.build_ir( image ).ir, std::move( labels ) };
+
+    const IRBundle loaded = deserialise_bundle( std::make_shared<const std::vector<uint8_t>>( serialise_bundle( bundle ) ) );
+
+    std::vector<uint16_t> addresses;
+    loaded.resolver->for_each_label( [&addresses]( uint16_t address, std::string_view ) { addresses.push_back( address ); } );
+
+    EXPECT_EQ( addresses, ( std::vector<uint16_t> { 0x0200, 0x0FFE, 0x2400 } ) );
+    EXPECT_EQ( loaded.resolver->get_label( 0x2400 ), "FAR" );
+}
+
+TEST_F(IRCacheTest, damaged_files_are_rejected)
+{
+    std::vector<uint8_t> bytes = serialise_bundle( dis.build_ir( image ), 42 );
+
+    EXPECT_THROW( deserialise_bundle( std::make_shared<const std::vector<uint8_t>>( bytes ), 43 ), std::runtime_error );
+
+    bytes.pop_back();
+    EXPECT_THROW( deserialise_bundle( std::make_shared<const std::vector<uint8_t>>( bytes ), 42 ), std::runtime_error );
+
+    bytes[4] = ir_format_version + 1;
+    EXPECT_THROW( deserialise_bundle( std::make_shared<const std::vector<uint8_t>>( bytes ), 42 ), std::runtime_error );
+}
+
+TEST_F(IRCacheTest, damaged_instruction_records_are_rejected)
+{
+    const std::vector<uint8_t> bytes = serialise_bundle( dis.build_ir( image ), 42 );
+    const size_t first_record = 40;     // right after the header
+
+    std::vector<uint8_t> bad_opcode = bytes;
+    bad_opcode[first_record] = 0xEE;
+    EXPECT_THROW( deserialise_bundle( std::make_shared<const std::vector<uint8_t>>( bad_opcode ), 42 ), std::runtime_error );
+
+    std::vector<uint8_t> bad_address = bytes;
+    bad_address[first_record + 4] = 0xFF;
+    bad_address[first_record + 5] = 0xFF;
+    EXPECT_THROW( deserialise_bundle( std::make_shared<const std::vector<uint8_t>>( bad_address ), 42 ), std::runtime_error );
+}
+
+TEST_F(IRCacheTest, keys_follow_input_configuration_and_producer)
+{
+    const uint64_t key = content_key( image, 0x200, 1 );
+
+    EXPECT_EQ( content_key( image, 0x200, 1 ), key );
+    EXPECT_NE( content_key( image, 0x600, 1 ), key );
+    EXPECT_NE( content_key( image, 0x200, 2 ), key );
+
+    BinImage changed = image;
+    changed.back() ^= 1;
+    EXPECT_NE( content_key( changed, 0x200, 1 ), key );
+}
+
+TEST_F(IRCacheTest, second_build_is_a_hit)
+{
+    const IRCache cache( directory );
+    const uint64_t key = content_key( image, 0x200, 1 );
+    int builds = 0;
+
+    auto build = [&] { ++builds; return dis.build_ir( image ); };
+
+    const IRBundle first = cache.get_or_build( key, build );
+    const IRBundle second = cache.get_or_build( key, build );
+
+    EXPECT_EQ( builds, 1 );
+    EXPECT_EQ( second.ir, first.ir );
+
+    std::ofstream( directory / std::filesystem::directory_iterator( directory )->path().filename(), std::ios::trunc ) << "junk";
+    cache.get_or_build( key, build );
+    EXPECT_EQ( builds, 2 );
+}
+
+TEST_F(IRCacheTest, cache_without_a_directory_always_builds)
+{
+    const IRCache cache { std::filesystem::path() };
+    int builds = 0;
+
+    cache.get_or_build( 1, [&] { ++builds; return dis.build_ir( image ); } );
+    cache.get_or_build( 1, [&] { ++builds; return dis.build_ir( image ); } );
+
+    EXPECT_EQ( builds, 2 );
+}
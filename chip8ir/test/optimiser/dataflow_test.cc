@@ -0,0 +1,235 @@
+/*
+ * dataflow_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include "optimiser/analyses.h"
+
+class DataFlowTest : public ::testing::Test
+{
+protected:
+    IRProgram ir;
+
+    // Lays instructions out from the origin, two bytes apart
+    void program( std::initializer_list<Instruction> instructions )
+    {
+        uint16_t address = ir.origin;
+
+        for( const Instruction& instruction : instructions ) {
+            ir.elements.push_back( InstructionElement{ address, instruction } );
+            address += 2;
+        }
+    }
+
+    static RegisterSet regs( std::initializer_list<uint8_t> indices )
+    {
+        RegisterSet set = 0;
+        for( uint8_t index : indices )
+            set |= RegisterSet( 1u << index );
+        return set;
+    }
+};
+
+TEST_F(DataFlowTest, blocks_end_at_branches_and_start_at_targets)
+{
+    program( {
+        Instruction::make_ld( Reg{0}, Imm{0} ),             // 0x200
+        Instruction::make_add( Reg{0}, Imm{1} ),            // 0x202 loop
+        Instruction::make_skip_eq( Reg{0}, Imm{10} ),       // 0x204
+        Instruction::make_jump( Addr{0x202} ),              // 0x206
+        Instruction::make_call( Addr{0x20C} ),              // 0x208
+        Instruction::make_return(),                         // 0x20A
+        Instruction::make_return(),                         // 0x20C routine
+    } );
+
+    BlockGraph graph( ir );
+    const auto& blocks = graph.blocks();
+
+    ASSERT_EQ( blocks.size(), 6u );
+
+    EXPECT_EQ( graph.block_of( graph.instruction_index( 0x202 ) ), 1u );
+    EXPECT_EQ( blocks[1].first, 1u );
+    EXPECT_EQ( blocks[1].last, 3u );
+    EXPECT_EQ( blocks[1].successors, std::vector<uint32_t>( { 2, 3 } ) );
+    EXPECT_EQ( blocks[2].successors, std::vector<uint32_t>( { 1 } ) );
+
+    EXPECT_TRUE( blocks[0].entry );
+    EXPECT_TRUE( blocks[5].entry );                     // called
+    EXPECT_TRUE( blocks[4].exit );
+    EXPECT_EQ( graph.instruction_index( 0x201 ), BlockGraph::none );
+}
+
+TEST_F(DataFlowTest, liveness_follows_reads_back_to_writes)
+{
+    program( {
+        Instruction::make_ld( Reg{0}, Imm{5} ),             // 0x200
+        Instruction::make_ld( Reg{1}, Imm{8} ),             // 0x202 dead, overwritten below
+        Instruction::make_ld( Reg{1}, Reg{0} ),             // 0x204
+        Instruction::make_skip_eq( Reg{2}, Imm{0} ),        // 0x206
+        Instruction::make_add( Reg{1}, Reg{3} ),            // 0x208
+        Instruction::make_drw( Reg{1}, Reg{4}, Nibble{5} ), // 0x20A
+        Instruction::make_jump( Addr{0x20C} ),              // 0x20C
+    } );
+
+    BlockGraph graph( ir );
+    DataFlow<Liveness> live( graph );
+
+    EXPECT_EQ( live.before( 0x200 ), regs( { 2, 3, 4 } ) );
+    EXPECT_EQ( live.after( 0x202 ), regs( { 0, 2, 3, 4 } ) );
+    EXPECT_EQ( live.after( 0x206 ), regs( { 1, 3, 4 } ) );
+    EXPECT_EQ( live.after( 0x208 ), regs( { 1, 4 } ) );
+    EXPECT_EQ( live.after( 0x20A ), 0u );                // spins forever, nothing is read again
+}
+
+TEST_F(DataFlowTest, liveness_assumes_callers_read_everything)
+{
+    program( {
+        Instruction::make_ld( Reg{5}, Imm{1} ),             // 0x200
+        Instruction::make_return(),                         // 0x202
+    } );
+
+    BlockGraph graph( ir );
+    DataFlow<Liveness> live( graph );
+
+    EXPECT_EQ( live.after( 0x200 ), all_registers );
+    EXPECT_EQ( live.before( 0x200 ), RegisterSet( all_registers & ~regs( { 5 } ) ) );
+}
+
+TEST_F(DataFlowTest, constants_survive_paths_that_agree)
+{
+    program( {
+        Instruction::make_ld( Reg{1}, Imm{3} ),             // 0x200
+        Instruction::make_skip_eq( Reg{0}, Imm{0} ),        // 0x202
+        Instruction::make_ld( Reg{2}, Imm{7} ),             // 0x204
+        Instruction::make_ld( Reg{2}, Imm{7} ),             // 0x206 both paths give V2 7
+        Instruction::make_add( Reg{2}, Reg{1} ),            // 0x208 V2 10, VF 0
+        Instruction::make_sub( Reg{1}, Reg{2} ),            // 0x20A V1 0xF9, VF 0
+        Instruction::make_rnd( Reg{3}, Imm{0xFF} ),         // 0x20C
+        Instruction::make_jump( Addr{0x20E} ),              // 0x20E
+    } );
+
+    BlockGraph graph( ir );
+    DataFlow<ConstantPropagation> constants( graph );
+
+    const RegisterConstants at_end = constants.before( 0x20E );
+
+    EXPECT_EQ( at_end.constant( Reg{0} ), std::nullopt );
+    EXPECT_EQ( at_end.constant( Reg{1} ), 0xF9 );
+    EXPECT_EQ( at_end.constant( Reg{2} ), 10 );
+    EXPECT_EQ( at_end.constant( Reg{3} ), std::nullopt );
+    EXPECT_EQ( at_end.constant( Reg{0xF} ), 0 );
+}
+
+TEST_F(DataFlowTest, loop_counters_vary_but_loop_invariants_stay_constant)
+{
+    program( {
+        Instruction::make_ld( Reg{0}, Imm{0} ),             // 0x200
+        Instruction::make_ld( Reg{1}, Imm{4} ),             // 0x202
+        Instruction::make_add( Reg{0}, Imm{1} ),            // 0x204 loop
+        Instruction::make_or( Reg{1}, Reg{1} ),             // 0x206
+        Instruction::make_skip_eq( Reg{0}, Imm{10} ),       // 0x208
+        Instruction::make_jump( Addr{0x204} ),              // 0x20A
+        Instruction::make_jump( Addr{0x20C} ),              // 0x20C
+    } );
+
+    BlockGraph graph( ir );
+    DataFlow<ConstantPropagation> constants( graph );
+
+    const RegisterConstants in_loop = constants.before( 0x208 );
+
+    EXPECT_EQ( in_loop.constant( Reg{0} ), std::nullopt );
+    EXPECT_EQ( in_loop.constant( Reg{1} ), 4 );
+    EXPECT_EQ( in_loop.constant( Reg{0xF} ), std::nullopt );  // OR may clear VF
+}
+
+TEST_F(DataFlowTest, reaching_definitions_merge_at_joins)
+{
+    program( {
+        Instruction::make_ld( Reg{0}, Imm{1} ),             // 0x200
+        Instruction::make_skip_eq( Reg{1}, Imm{0} ),        // 0x202
+        Instruction::make_ld( Reg{0}, Imm{2} ),             // 0x204
+        Instruction::make_xor( Reg{2}, Reg{0} ),            // 0x206
+        Instruction::make_jump( Addr{0x208} ),              // 0x208
+    } );
+
+    BlockGraph graph( ir );
+    DataFlow<ReachingDefinitions> reaching( graph );
+
+    const Definitions at_join = reaching.before( 0x206 );
+
+    EXPECT_EQ( at_join.sites[0], std::vector<uint16_t>( { 0x200, 0x204 } ) );
+    EXPECT_EQ( at_join.outside, RegisterSet( all_registers & ~regs( { 0 } ) ) );
+
+    const Definitions after_xor = reaching.after( 0x206 );
+
+    EXPECT_EQ( after_xor.sites[2], std::vector<uint16_t>( { 0x206 } ) );
+    EXPECT_EQ( after_xor.sites[0xF], std::vector<uint16_t>( { 0x206 } ) );
+    EXPECT_TRUE( after_xor.outside & regs( { 0xF } ) );    // XOR may leave VF alone
+}
+
+TEST_F(DataFlowTest, whole_address_space_program_is_solved)
+{
+    // Loops over the first 4K, then straight-line code filling the rest of memory
+    std::vector<ASMElement>& elements = ir.elements;
+
+    for( uint32_t address = ir.origin; address + 2 <= 0x10000; address += 2 ) {
+        const uint8_t x = ( address >> 1 ) & 0xF;
+        Instruction instruction = Instruction::make_add( Reg{x}, Reg{uint8_t( ( x + 1 ) & 0xF )} );
+
+        if( address < 0x1000 && ( address & 0x3F ) == 0x3E )
+            instruction = Instruction::make_skip_eq( Reg{x}, Imm{0} );
+        else if( address < 0x1000 && ( address & 0x3F ) == 0x3C )
+            instruction = Instruction::make_jump( Addr{uint16_t( address & ~0x1FF )} );
+        else if( ( address & 0xF ) == 0 )
+            instruction = Instruction::make_ld( Reg{x}, Imm{uint8_t( address )} );
+
+        elements.push_back( InstructionElement{ uint16_t( address ), instruction } );
+    }
+
+    BlockGraph graph( ir );
+    DataFlow<Liveness> live( graph );
+    DataFlow<ConstantPropagation> constants( graph );
+    DataFlow<ReachingDefinitions> reaching( graph );
+
+    EXPECT_EQ( graph.instructions().size(), elements.size() );
+    EXPECT_EQ( live.after( 0xFFFE ), all_registers );        // runs off the end of memory
+    EXPECT_EQ( constants.after( 0xFFF0 ).constant( Reg{8} ), 0xF0 );
+    EXPECT_EQ( reaching.before( 0xFFF2 ).sites[8], std::vector<uint16_t>( { 0xFFF0 } ) );
+}
+
+TEST_F(DataFlowTest, value_sets_follow_masks_and_shifts)
+{
+    program( {
+        Instruction::make_store_key( Reg{1} ),              // 0x200 V1 is 0 to 15
+        Instruction::make_ld( Reg{2}, Imm{3} ),             // 0x202
+        Instruction::make_and( Reg{1}, Reg{2} ),            // 0x204 0 to 3
+        Instruction::make_shift_left( Reg{1}, Reg{1} ),     // 0x206 0, 2, 4, 6
+        Instruction::make_ld( Reg{0}, Reg{1} ),             // 0x208
+        Instruction::make_jump_indexed( Addr{0x300} ),      // 0x20A
+    } );
+
+    BlockGraph graph( ir );
+    DataFlow<ValueSetAnalysis> value_sets( graph );
+
+    const ValueSets at_jump = value_sets.before( 0x20A );
+
+    EXPECT_EQ( at_jump.registers[0], std::bitset<256>( 0b1010101 ) );
+    EXPECT_EQ( at_jump.registers[0xF], std::bitset<256>( 0b1 ) );    // the bit shifted out is clear
+    EXPECT_TRUE( value_sets.before( 0x200 ).registers[0].all() );
+}
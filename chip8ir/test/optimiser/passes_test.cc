@@ -0,0 +1,226 @@
+/*
+ * passes_test.cc Copyright 2026 Alwin Leerling dna.leerling@gmail.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include <gtest/gtest.h>
+
+#include "disassembler/disassembler.h"
+#include "ir/encoder.h"
+#include "optimiser/passes.h"
+
+class PassesTest : public ::testing::Test
+{
+protected:
+    Disassembler dis;
+    Relocation relocation;
+    std::vector<PassReport> reports;
+
+    void SetUp() override {
+        dis.configure({0x200});
+    }
+
+    template<typename... Passes>
+    BinImage optimise( const BinImage& bin )
+    {
+        IRProgram ir = dis.build_ir( bin ).ir;
+        PassManager manager;
+
+        ( manager.add( std::make_unique<Passes>() ), ... );
+        reports = manager.run( ir, relocation );
+
+        return BinaryEncoder().encode( ir );
+    }
+};
+
+TEST_F(PassesTest, repeated_i_load_is_removed)
+{
+    BinImage image = optimise<RedundantILoadPass>( {
+        0xA2, 0x0C,     // 0x200 LD I, 0x20C
+        0xD0, 0x15,     // 0x202 DRW V0, V1, 5
+        0xA2, 0x0C,     // 0x204 LD I, 0x20C     I still holds it
+        0xD2, 0x35,     // 0x206 DRW V2, V3, 5
+        0x12, 0x08,     // 0x208 JP 0x208
+        0x00, 0x00,
+        0xF0, 0x90,     // 0x20C sprite
+    } );
+
+    EXPECT_EQ( image, BinImage( {
+        0xA2, 0x0A,
+        0xD0, 0x15,
+        0xD2, 0x35,
+        0x12, 0x06,
+        0x00, 0x00,
+        0xF0, 0x90,
+    } ) );
+
+    ASSERT_EQ( reports.size(), 1u );
+    EXPECT_EQ( reports[0].changes, 1u );
+    EXPECT_EQ( reports[0].bytes_saved, 2u );
+    EXPECT_EQ( relocation( 0x20C ), 0x20A );
+}
+
+TEST_F(PassesTest, i_load_that_may_be_skipped_stays)
+{
+    const BinImage program = {
+        0xA2, 0x08,     // 0x200 LD I, 0x208
+        0x30, 0x00,     // 0x202 SE V0, 0
+        0xA2, 0x08,     // 0x204 LD I, 0x208     removing it would change what the SE skips
+        0x12, 0x06,     // 0x206 JP 0x206
+        0xF0, 0x90,
+    };
+
+    EXPECT_EQ( optimise<RedundantILoadPass>( program ), program );
+}
+
+TEST_F(PassesTest, overwritten_load_is_dead)
+{
+    BinImage image = optimise<DeadStorePass>( {
+        0x60, 0x05,     // 0x200 LD V0, 5        dead
+        0x61, 0x06,     // 0x202 LD V1, 6        read by the ADD
+        0x60, 0x07,     // 0x204 LD V0, 7
+        0x80, 0x14,     // 0x206 ADD V0, V1
+        0x61, 0x08,     // 0x208 LD V1, 8        live at the jump
+        0x12, 0x00,     // 0x20A JP 0x200
+    } );
+
+    EXPECT_EQ( image, BinImage( {
+        0x61, 0x06,
+        0x60, 0x07,
+        0x80, 0x14,
+        0x61, 0x08,
+        0x12, 0x00,
+    } ) );
+}
+
+TEST_F(PassesTest, overwrite_that_may_be_skipped_keeps_the_load)
+{
+    const BinImage program = {
+        0x60, 0x05,     // 0x200 LD V0, 5
+        0x31, 0x00,     // 0x202 SE V1, 0
+        0x60, 0x07,     // 0x204 LD V0, 7
+        0xF0, 0x29,     // 0x206 LD F, V0
+        0x12, 0x08,     // 0x208 JP 0x208
+    };
+
+    EXPECT_EQ( optimise<DeadStorePass>( program ), program );
+}
+
+TEST_F(PassesTest, skip_over_jump_is_inverted)
+{
+    BinImage image = optimise<SkipJumpInversionPass>( {
+        0x30, 0x01,     // 0x200 SE V0, 1
+        0x12, 0x06,     // 0x202 JP 0x206
+        0x61, 0x05,     // 0x204 LD V1, 5
+        0x12, 0x06,     // 0x206 JP 0x206
+    } );
+
+    EXPECT_EQ( image, BinImage( {
+        0x40, 0x01,     // SNE V0, 1
+        0x61, 0x05,
+        0x12, 0x04,
+    } ) );
+
+    EXPECT_EQ( reports[0].bytes_saved, 2u );
+    EXPECT_EQ( reports[0].cycles_saved, 1u );
+}
+
+TEST_F(PassesTest, jump_to_jump_is_threaded_and_the_middle_dropped)
+{
+    BinImage image = optimise<JumpThreadingPass, UnreachableCodePass>( {
+        0x22, 0x08,     // 0x200 CALL 0x208
+        0x12, 0x06,     // 0x202 JP 0x206
+        0x00, 0x00,
+        0x12, 0x06,     // 0x206 JP 0x206
+        0x12, 0x0A,     // 0x208 JP 0x20A
+        0x00, 0xEE,     // 0x20A RET
+    } );
+
+    EXPECT_EQ( image, BinImage( {
+        0x22, 0x08,     // CALL straight to the RET
+        0x12, 0x06,
+        0x00, 0x00,
+        0x12, 0x06,
+        0x00, 0xEE,
+    } ) );
+
+    ASSERT_EQ( reports.size(), 2u );
+    EXPECT_EQ( reports[0].changes, 1u );
+    EXPECT_EQ( reports[0].cycles_saved, 1u );
+    EXPECT_EQ( reports[1].bytes_saved, 2u );
+}
+
+TEST_F(PassesTest, jump_tables_are_left_alone)
+{
+    const BinImage program = {
+        0xB2, 0x04,     // 0x200 JP V0, 0x204
+        0x00, 0x00,
+        0x12, 0x08,     // 0x204 JP 0x208
+        0x12, 0x0A,     // 0x206 JP 0x20A
+        0x12, 0x0C,     // 0x208 JP 0x20C
+        0x12, 0x0C,     // 0x20A JP 0x20C
+        0x12, 0x0C,     // 0x20C JP 0x20C
+    };
+
+    BinImage image = optimise<JumpThreadingPass, UnreachableCodePass>( program );
+
+    EXPECT_EQ( image, BinImage( {
+        0xB2, 0x04,
+        0x00, 0x00,
+        0x12, 0x08,     // table entries keep their targets
+        0x12, 0x0A,
+        0x12, 0x0C,
+        0x12, 0x0C,
+        0x12, 0x0C,
+    } ) );
+    EXPECT_EQ( reports[1].changes, 0u );
+}
+
+TEST_F(PassesTest, targets_outside_the_image_keep_their_address)
+{
+    BinImage image = optimise<RedundantILoadPass, DeadStorePass, SkipJumpInversionPass, JumpThreadingPass, UnreachableCodePass>( {
+        0x61, 0x05,     // 0x200 LD V1, 5        dead
+        0x61, 0x06,     // 0x202 LD V1, 6
+        0xAE, 0x00,     // 0x204 LD I, 0xE00     scratch RAM past the image
+        0xF1, 0x55,     // 0x206 LD [I], V1
+        0x2E, 0x10,     // 0x208 CALL 0xE10      routine outside the image
+        0x12, 0x0A,     // 0x20A JP 0x20A
+    } );
+
+    EXPECT_EQ( image, BinImage( {
+        0x61, 0x06,
+        0xAE, 0x00,
+        0xF1, 0x55,
+        0x2E, 0x10,
+        0x12, 0x08,
+    } ) );
+
+    EXPECT_EQ( relocation( 0x20A ), 0x208 );
+    EXPECT_EQ( relocation( 0xE00 ), 0xE00 );
+    EXPECT_EQ( relocation( 0x100 ), 0x100 );
+}
+
+TEST_F(PassesTest, standard_pipeline_reports_every_pass)
+{
+    IRProgram ir = dis.build_ir( { 0x12, 0x00 } ).ir;
+
+    reports = PassManager::standard().run( ir );
+
+    ASSERT_EQ( reports.size(), 5u );
+    EXPECT_EQ( reports[0].pass, "redundant-ld-i" );
+    EXPECT_EQ( reports[4].pass, "unreachable-code" );
+}
@@ -24,10 +24,13 @@
 #include "ir/asm_emitter.h"
 #include "ir/encoder.h"
 #include "ir/ir_bundle.h"
+#include "ir/ir_cache.h"
 
 #include "assembler/assembler.h"
 #include "assembler/loader.h"
 
+#include "optimiser/pass_manager.h"
+
 int main( int argc, char ** argv )
 {
 	try {
@@ -44,6 +47,19 @@ int main( int argc, char ** argv )
 
 		IRBundle bundle = assembler.build_ir( source );
 
+		if( args.is_optimised() ) {
+			Relocation relocation;
+			std::vector<PassReport> reports = PassManager::standard().run( bundle.ir, relocation );
+
+			// Labels follow the code they name
+			auto labels = std::make_unique<LabelTable>();
+			bundle.resolver->for_each_label( [&]( uint16_t address, std::string_view label ) { labels->add( relocation( address ), std::string( label ) ); } );
+			bundle.resolver = std::move( labels );
+
+			if( args.is_verbose() )
+				print_reports( std::cout, reports );
+		}
+
 		BinImage bin_image = BinaryEncoder().encode(bundle.ir);
 
 		std::ofstream os( args.get_binary_name(), std::ios::binary );
@@ -22,6 +22,7 @@
 
 #include "ir/binary_loader.h"
 #include "ir/ir_bundle.h"
+#include "ir/ir_cache.h"
 
 #include "disassembler/disassembler.h"
 
@@ -41,7 +42,8 @@ int main( int argc, char ** argv )
 		std::ifstream is( args.get_program(), std::ios::binary );
 		BinImage image = load_binary( is );
 
-		IRBundle bundle = disassembler.build_ir( image );
+		IRCache cache;
+		IRBundle bundle = cache.get_or_build( content_key( image, args.get_origin(), Disassembler::ir_version ), [&] { return disassembler.build_ir( image ); } );
 
         Emulator emulator;
         emulator.configure( args );
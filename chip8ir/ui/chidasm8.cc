@@ -24,6 +24,7 @@
 #include "ir/asm_emitter.h"
 #include "ir/cfg_emitter.h"
 #include "ir/ir_bundle.h"
+#include "ir/ir_cache.h"
 
 #include "disassembler/cmdlineparser.h"
 #include "disassembler/disassembler.h"
@@ -42,7 +43,8 @@ int main( int argc, char ** argv )
 		std::ifstream is( args.get_source_name(), std::ios::binary );
 		BinImage image = load_binary( is );
 
-		IRBundle bundle = disassembler.build_ir( image );
+		IRCache cache;
+		IRBundle bundle = cache.get_or_build( content_key( image, args.get_origin(), Disassembler::ir_version ), [&] { return disassembler.build_ir( image ); } );
 
 		std::ofstream os( args.get_output_name() );
 		ASMEmitter emitter;